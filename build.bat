@@ -21,6 +21,11 @@ if "%~1"=="" (
 	set compilerFlags=%compilerFlags% /Od /MTd /D_DEBUG
 	set rayname=d_raylib
 )
+if "%~1"=="-Profile" (
+	echo [[ profile build ]]
+	set compilerFlags=%compilerFlags% /O2 /MT /DPROFILE
+	set rayname=raylib
+)
 if "%~1"=="-Release" (
 	echo [[ release build ]]
 	set compilerFlags=%compilerFlags% /O2 /MT 
@@ -40,4 +45,8 @@ del /Q *.obj
 )
 
 cl.exe %compilerFlags% %warnings% %includes% ../source/Main.cpp /link %linkerFlags% %rayname%.lib %linkerLibs%
+
+REM Block-compress textures next to their PNGs; up-to-date ones are skipped
+cl.exe %compilerFlags% %warnings% %includes% ../source/CompressTextures.cpp /link /OUT:CompressTextures.exe %rayname%.lib %linkerLibs%
+CompressTextures.exe ../resources ../resources/models .
 popd
\ No newline at end of file
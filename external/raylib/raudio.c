@@ -467,6 +467,25 @@ void InitAudioDevice(void)
     config.pUserData = NULL;
 
     result = ma_device_init(&AUDIO.System.context, &config, &AUDIO.System.device);
+
+    // No playback device (e.g. a headless machine with a sound server installed):
+    // retry on the null backend, which consumes the mix at real-time pace without output
+    if ((result != MA_SUCCESS) && (AUDIO.System.context.backend != ma_backend_null))
+    {
+        TRACELOG(LOG_WARNING, "AUDIO: Failed to initialize playback device, falling back to null backend");
+        ma_context_uninit(&AUDIO.System.context);
+
+        ma_backend nullBackend = ma_backend_null;
+        result = ma_context_init(&nullBackend, 1, &ctxConfig, &AUDIO.System.context);
+        if (result != MA_SUCCESS)
+        {
+            TRACELOG(LOG_WARNING, "AUDIO: Failed to initialize context");
+            return;
+        }
+
+        result = ma_device_init(&AUDIO.System.context, &config, &AUDIO.System.device);
+    }
+
     if (result != MA_SUCCESS)
     {
         TRACELOG(LOG_WARNING, "AUDIO: Failed to initialize playback device");
@@ -1975,6 +1994,98 @@ void UpdateMusicStream(Music music)
     if (IsMusicStreamPlaying(music)) PlayMusicStream(music);
 }
 
+// Decode the next frames of a music stream into a buffer, returns the number of frames decoded
+// NOTE: Frames are 32bit float for streams with a sample size of 32, 16bit otherwise, in the stream channels;
+// the music loops back to its start without a gap. Only the decoder context is used (no audio buffer, no
+// mixer lock), so any thread can decode a music that is not also played with UpdateMusicStream()
+unsigned int DecodeMusicStream(Music music, void *frames, unsigned int frameCount)
+{
+    if ((music.ctxData == NULL) || (frames == NULL)) return 0;
+
+    int frameSize = music.stream.channels*((music.stream.sampleSize == 32)? 4 : 2);
+    unsigned int frameCountRead = 0;
+    bool rewound = false;       // Nothing decoded since the last rewind, stop instead of looping forever
+
+    while (frameCountRead < frameCount)
+    {
+        void *framesOut = (char *)frames + frameCountRead*frameSize;
+        unsigned int frameCountStillNeeded = frameCount - frameCountRead;
+        unsigned int frameCountJustRead = 0;
+
+        switch (music.ctxType)
+        {
+        #if defined(SUPPORT_FILEFORMAT_WAV)
+            case MUSIC_AUDIO_WAV:
+            {
+                if (music.stream.sampleSize == 32) frameCountJustRead = (unsigned int)drwav_read_pcm_frames_f32((drwav *)music.ctxData, frameCountStillNeeded, (float *)framesOut);
+                else frameCountJustRead = (unsigned int)drwav_read_pcm_frames_s16((drwav *)music.ctxData, frameCountStillNeeded, (short *)framesOut);
+
+                if (frameCountJustRead < frameCountStillNeeded) drwav_seek_to_first_pcm_frame((drwav *)music.ctxData);
+            } break;
+        #endif
+        #if defined(SUPPORT_FILEFORMAT_OGG)
+            case MUSIC_AUDIO_OGG:
+            {
+                frameCountJustRead = stb_vorbis_get_samples_short_interleaved((stb_vorbis *)music.ctxData, music.stream.channels, (short *)framesOut, frameCountStillNeeded*music.stream.channels);
+
+                if (frameCountJustRead < frameCountStillNeeded) stb_vorbis_seek_start((stb_vorbis *)music.ctxData);
+            } break;
+        #endif
+        #if defined(SUPPORT_FILEFORMAT_MP3)
+            case MUSIC_AUDIO_MP3:
+            {
+                frameCountJustRead = (unsigned int)drmp3_read_pcm_frames_f32((drmp3 *)music.ctxData, frameCountStillNeeded, (float *)framesOut);
+
+                if (frameCountJustRead < frameCountStillNeeded) drmp3_seek_to_start_of_stream((drmp3 *)music.ctxData);
+            } break;
+        #endif
+        #if defined(SUPPORT_FILEFORMAT_QOA)
+            case MUSIC_AUDIO_QOA:
+            {
+                // NOTE: QOA decoder loops by itself
+                frameCountJustRead = qoaplay_decode((qoaplay_desc *)music.ctxData, (float *)framesOut, frameCountStillNeeded);
+            } break;
+        #endif
+        #if defined(SUPPORT_FILEFORMAT_FLAC)
+            case MUSIC_AUDIO_FLAC:
+            {
+                frameCountJustRead = (unsigned int)drflac_read_pcm_frames_s16((drflac *)music.ctxData, frameCountStillNeeded, (short *)framesOut);
+
+                if (frameCountJustRead < frameCountStillNeeded) drflac__seek_to_first_frame((drflac *)music.ctxData);
+            } break;
+        #endif
+        #if defined(SUPPORT_FILEFORMAT_XM)
+            case MUSIC_MODULE_XM:
+            {
+                // NOTE: Modules are generated endlessly, always 2 channels
+                if (music.stream.sampleSize == 32) jar_xm_generate_samples((jar_xm_context_t *)music.ctxData, (float *)framesOut, frameCountStillNeeded);
+                else jar_xm_generate_samples_16bit((jar_xm_context_t *)music.ctxData, (short *)framesOut, frameCountStillNeeded);
+                frameCountJustRead = frameCountStillNeeded;
+            } break;
+        #endif
+        #if defined(SUPPORT_FILEFORMAT_MOD)
+            case MUSIC_MODULE_MOD:
+            {
+                jar_mod_fillbuffer((jar_mod_context_t *)music.ctxData, (short *)framesOut, frameCountStillNeeded, 0);
+                frameCountJustRead = frameCountStillNeeded;
+            } break;
+        #endif
+            default: break;
+        }
+
+        if (frameCountJustRead == 0)
+        {
+            if (rewound || (music.ctxType == MUSIC_AUDIO_NONE)) break;
+            rewound = true;
+        }
+        else rewound = false;
+
+        frameCountRead += frameCountJustRead;
+    }
+
+    return frameCountRead;
+}
+
 // Check if any music is playing
 bool IsMusicStreamPlaying(Music music)
 {
@@ -1622,6 +1622,7 @@ RLAPI void UnloadMusicStream(Music music);                            // Unload
 RLAPI void PlayMusicStream(Music music);                              // Start music playing
 RLAPI bool IsMusicStreamPlaying(Music music);                         // Check if music is playing
 RLAPI void UpdateMusicStream(Music music);                            // Updates buffers for music streaming
+RLAPI unsigned int DecodeMusicStream(Music music, void *frames, unsigned int frameCount); // Decode next music frames into a buffer (any thread, loops gapless)
 RLAPI void StopMusicStream(Music music);                              // Stop music playing
 RLAPI void PauseMusicStream(Music music);                             // Pause music playing
 RLAPI void ResumeMusicStream(Music music);                            // Resume playing paused music
@@ -0,0 +1,109 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec3 fragPosition;
+in vec2 fragTexCoord;
+//in vec4 fragColor;
+in vec3 fragNormal;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+
+// Output fragment color
+out vec4 finalColor;
+
+// Same lighting as lighting.fs for any number of lights. The lights live in a
+// data texture and the view frustum is split in clusters (screen tiles by
+// depth slices); each cluster lists the point lights whose range reaches it,
+// so a fragment only visits the lights near it. Directional lights come first
+// in the light data and apply everywhere.
+
+#define     LIGHT_DIRECTIONAL       0
+#define     LIGHT_POINT             1
+#define     LIGHT_INDEX_WIDTH       1024
+
+// Input lighting values
+uniform sampler2D lightData;        // Row per light: (position, radius), (color, type), (direction, 0)
+uniform sampler2D lightGrid;        // Texel per cluster (x: tile, y: slice): first index, light count
+uniform sampler2D lightIndices;     // Light numbers of all clusters, LIGHT_INDEX_WIDTH per row
+uniform int lightCount;
+uniform int directionalCount;
+uniform int clustered;              // 0: every light is visited (for comparison)
+uniform ivec3 clusterCount;         // Tiles across, tiles down, depth slices
+uniform vec2 clusterTileSize;       // Tile size in pixels
+uniform vec4 viewDepth;             // Distance along the view direction: dot(xyz, position) + w
+uniform vec2 clusterDepth;          // Slice: log(depth)*x + y
+uniform vec4 ambient;
+uniform vec3 viewPos;
+
+vec3 lightDot = vec3(0.0);
+vec3 specular = vec3(0.0);
+
+void AddLight(int index, vec3 normal, vec3 viewD)
+{
+    vec4 positionRadius = texelFetch(lightData, ivec2(0, index), 0);
+    vec4 colorType = texelFetch(lightData, ivec2(1, index), 0);
+
+    vec3 light = vec3(0.0);
+    float falloff = 1.0;
+
+    if (int(colorType.w) == LIGHT_DIRECTIONAL)
+    {
+        light = -texelFetch(lightData, ivec2(2, index), 0).xyz;
+    }
+    else
+    {
+        vec3 toLight = positionRadius.xyz - fragPosition;
+        float range = length(toLight);
+        if (range >= positionRadius.w) return;
+
+        // Smooth window reaching zero at the light's radius
+        float ratio = range/positionRadius.w;
+        falloff = 1.0 - ratio*ratio;
+        falloff *= falloff;
+        light = toLight/max(range, 0.0001);
+    }
+
+    float NdotL = max(dot(normal, light), 0.0);
+    lightDot += colorType.rgb*NdotL*falloff;
+
+    float specCo = 0.0;
+    if (NdotL > 0.0) specCo = pow(max(0.0, dot(viewD, reflect(-(light), normal))), 16.0); // 16 refers to shine
+    specular += specCo*falloff;
+}
+
+void main()
+{
+    // Texel color fetching from texture sampler
+    vec4 texelColor = texture(texture0, fragTexCoord);
+    vec3 normal = normalize(fragNormal);
+    vec3 viewD = normalize(viewPos - fragPosition);
+
+    for (int i = 0; i < directionalCount; i++) AddLight(i, normal, viewD);
+
+    if (clustered == 1)
+    {
+        ivec2 tile = min(ivec2(gl_FragCoord.xy/clusterTileSize), clusterCount.xy - 1);
+        float depth = max(dot(viewDepth.xyz, fragPosition) + viewDepth.w, 0.0001);
+        int slice = int(clamp(log(depth)*clusterDepth.x + clusterDepth.y, 0.0, float(clusterCount.z - 1)));
+
+        vec2 cluster = texelFetch(lightGrid, ivec2(tile.x + tile.y*clusterCount.x, slice), 0).xy;
+        int first = int(cluster.x);
+        int count = int(cluster.y);
+        for (int i = first; i < first + count; i++)
+        {
+            AddLight(int(texelFetch(lightIndices, ivec2(i%LIGHT_INDEX_WIDTH, i/LIGHT_INDEX_WIDTH), 0).r), normal, viewD);
+        }
+    }
+    else
+    {
+        for (int i = directionalCount; i < lightCount; i++) AddLight(i, normal, viewD);
+    }
+
+    finalColor = (texelColor*((colDiffuse + vec4(specular, 1.0))*vec4(lightDot, 1.0)));
+    finalColor += texelColor*(ambient/10.0)*colDiffuse;
+
+    // Gamma correction
+    finalColor = pow(finalColor, vec4(1.0/2.2));
+}
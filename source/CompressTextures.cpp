@@ -0,0 +1,441 @@
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <raylib.h>
+
+// Offline texture compressor, run by build.bat after the build. Converts PNGs
+// into block-compressed DDS files with the whole mip chain precomputed, written
+// next to the source (name.png -> name.dds). The game and the model viewer load
+// the .dds instead of the .png when it is at least as new as the source.
+//
+// Format per file:
+//   *_n.png     normal map: BC3 in the DXT5nm layout, X in alpha and Y in green;
+//               shaders rebuild Z as sqrt(1 - x*x - y*y)
+//   *_mra.png   metalness/roughness/occlusion: BC1
+//   others      BC1 when fully opaque, BC3 otherwise
+//
+// raylib's pixel formats stop at DXT1/3/5, so BC4/BC5 textures could not be
+// loaded by the runtime; DXT5nm keeps BC5's two-channel normal precision in a
+// format it can upload.
+
+// --- DDS ---
+namespace Dds {
+    constexpr uint32_t FOURCC_DXT1 = 0x31545844;  // "DXT1"
+    constexpr uint32_t FOURCC_DXT5 = 0x35545844;  // "DXT5"
+
+    // The 4 byte magic "DDS " is followed by this header and the mip levels, largest first.
+    struct Header {
+        uint32_t size = 124;
+        uint32_t flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;  // CAPS, HEIGHT, WIDTH, PIXELFORMAT, MIPMAPCOUNT, LINEARSIZE
+        uint32_t height = 0;
+        uint32_t width = 0;
+        uint32_t linearSize = 0;  // Bytes in the first level
+        uint32_t depth = 0;
+        uint32_t mipmapCount = 0;
+        uint32_t reserved1[11] = {};
+        uint32_t formatSize = 32;
+        uint32_t formatFlags = 0x4;  // FOURCC
+        uint32_t fourcc = 0;
+        uint32_t formatBits[5] = {};
+        uint32_t caps = 0x1000;  // TEXTURE, plus COMPLEX | MIPMAP with mips
+        uint32_t caps2 = 0;
+        uint32_t reserved2[3] = {};
+    };
+    static_assert(sizeof(Header) == 124, "DDS header layout");
+
+    inline int BlockBytes(uint32_t fourcc) {
+        return fourcc == FOURCC_DXT1 ? 8 : 16;
+    }
+
+    inline size_t LevelBytes(int width, int height, uint32_t fourcc) {
+        return static_cast<size_t>(std::max(1, (width + 3) / 4)) * std::max(1, (height + 3) / 4) * BlockBytes(fourcc);
+    }
+
+    // rlLoadTexture sizes each level as width*height*bpp/8 (8 or 16 bytes below
+    // 4x4), which only matches the real block count when both sides are
+    // multiples of 4 or both are under 4.
+    inline bool LevelLoadable(int width, int height) {
+        return (width % 4 == 0 && height % 4 == 0) || (width < 4 && height < 4);
+    }
+
+    // Levels to store: the full chain when every level is loadable, else the
+    // first level alone, else 0 (left as PNG). GL needs the full chain to
+    // sample with mipmaps, so a partial one is no use.
+    inline int MipCount(int width, int height) {
+        if (!LevelLoadable(width, height)) return 0;
+        int count = 1;
+        for (int w = width, h = height; w > 1 || h > 1; count++) {
+            w = std::max(1, w / 2);
+            h = std::max(1, h / 2);
+            if (!LevelLoadable(w, h)) return 1;
+        }
+        return count;
+    }
+}
+
+// --- BLOCK ENCODER ---
+// BC1 colour endpoints come from the principal axis of the block's colours,
+// inset slightly, then refined once by least squares over the chosen indices.
+// BC3 adds an alpha block with 8 interpolated values between min and max.
+namespace Bc {
+    struct Color3 {
+        float r, g, b;
+    };
+
+    inline uint16_t To565(Color3 c) {
+        int r = std::clamp(static_cast<int>(c.r * 31.0f / 255.0f + 0.5f), 0, 31);
+        int g = std::clamp(static_cast<int>(c.g * 63.0f / 255.0f + 0.5f), 0, 63);
+        int b = std::clamp(static_cast<int>(c.b * 31.0f / 255.0f + 0.5f), 0, 31);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    inline Color3 From565(uint16_t c) {
+        int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+        return { static_cast<float>((r << 3) | (r >> 2)), static_cast<float>((g << 2) | (g >> 4)), static_cast<float>((b << 3) | (b >> 2)) };
+    }
+
+    inline float Distance2(Color3 a, Color3 b) {
+        return (a.r - b.r) * (a.r - b.r) + (a.g - b.g) * (a.g - b.g) + (a.b - b.b) * (a.b - b.b);
+    }
+
+    inline Color3 Lerp(Color3 a, Color3 b, float t) {
+        return { a.r + (b.r - a.r) * t, a.g + (b.g - a.g) * t, a.b + (b.b - a.b) * t };
+    }
+
+    // Picks the nearest palette entry per pixel; returns the squared error.
+    inline float Fit(const Color3 pixels[16], uint16_t c0, uint16_t c1, uint8_t indices[16]) {
+        Color3 a = From565(c0), b = From565(c1);
+        const Color3 palette[4] = { a, b, Lerp(a, b, 1.0f / 3.0f), Lerp(a, b, 2.0f / 3.0f) };
+        float error = 0.0f;
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            float bestDistance = Distance2(pixels[i], palette[0]);
+            for (int p = 1; p < 4; p++) {
+                float d = Distance2(pixels[i], palette[p]);
+                if (d < bestDistance) { bestDistance = d; best = p; }
+            }
+            indices[i] = static_cast<uint8_t>(best);
+            error += bestDistance;
+        }
+        return error;
+    }
+
+    // Orders the endpoints for the four-colour mode (c0 > c1) and packs the block.
+    inline void Write(uint16_t c0, uint16_t c1, uint8_t indices[16], uint8_t out[8]) {
+        if (c0 < c1) {
+            std::swap(c0, c1);
+            static constexpr uint8_t SWAPPED[4] = { 1, 0, 3, 2 };
+            for (int i = 0; i < 16; i++) indices[i] = SWAPPED[indices[i]];
+        }
+        uint32_t bits = 0;
+        for (int i = 0; i < 16; i++) bits |= static_cast<uint32_t>(indices[i]) << (2 * i);
+        out[0] = static_cast<uint8_t>(c0);
+        out[1] = static_cast<uint8_t>(c0 >> 8);
+        out[2] = static_cast<uint8_t>(c1);
+        out[3] = static_cast<uint8_t>(c1 >> 8);
+        memcpy(out + 4, &bits, 4);
+    }
+
+    inline void EncodeColor(const uint8_t rgba[16][4], uint8_t out[8]) {
+        Color3 pixels[16];
+        Color3 mean = { 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < 16; i++) {
+            pixels[i] = { static_cast<float>(rgba[i][0]), static_cast<float>(rgba[i][1]), static_cast<float>(rgba[i][2]) };
+            mean = { mean.r + pixels[i].r / 16.0f, mean.g + pixels[i].g / 16.0f, mean.b + pixels[i].b / 16.0f };
+        }
+
+        float cov[6] = {};  // rr rg rb gg gb bb
+        for (const Color3& p : pixels) {
+            float r = p.r - mean.r, g = p.g - mean.g, b = p.b - mean.b;
+            cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+            cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+        }
+        Color3 axis = { 1.0f, 1.0f, 1.0f };
+        for (int i = 0; i < 8; i++) {
+            Color3 next = { cov[0] * axis.r + cov[1] * axis.g + cov[2] * axis.b,
+                            cov[1] * axis.r + cov[3] * axis.g + cov[4] * axis.b,
+                            cov[2] * axis.r + cov[4] * axis.g + cov[5] * axis.b };
+            float length = std::sqrt(next.r * next.r + next.g * next.g + next.b * next.b);
+            if (length < 1e-6f) break;  // Flat block: any axis will do
+            axis = { next.r / length, next.g / length, next.b / length };
+        }
+
+        float lo = 0.0f, hi = 0.0f;
+        for (const Color3& p : pixels) {
+            float t = (p.r - mean.r) * axis.r + (p.g - mean.g) * axis.g + (p.b - mean.b) * axis.b;
+            lo = std::min(lo, t);
+            hi = std::max(hi, t);
+        }
+        float inset = (hi - lo) / 16.0f;
+        uint16_t c0 = To565(Lerp(mean, { mean.r + axis.r, mean.g + axis.g, mean.b + axis.b }, hi - inset));
+        uint16_t c1 = To565(Lerp(mean, { mean.r + axis.r, mean.g + axis.g, mean.b + axis.b }, lo + inset));
+
+        uint8_t indices[16];
+        float error = Fit(pixels, c0, c1, indices);
+
+        // Least squares endpoints for the chosen indices: p = a*w + b*(1 - w)
+        static constexpr float WEIGHT[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        Color3 ax = { 0.0f, 0.0f, 0.0f }, bx = { 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < 16; i++) {
+            float w = WEIGHT[indices[i]], v = 1.0f - w;
+            aa += w * w; ab += w * v; bb += v * v;
+            ax = { ax.r + w * pixels[i].r, ax.g + w * pixels[i].g, ax.b + w * pixels[i].b };
+            bx = { bx.r + v * pixels[i].r, bx.g + v * pixels[i].g, bx.b + v * pixels[i].b };
+        }
+        float det = aa * bb - ab * ab;
+        if (std::fabs(det) > 1e-6f) {
+            Color3 a = { (ax.r * bb - bx.r * ab) / det, (ax.g * bb - bx.g * ab) / det, (ax.b * bb - bx.b * ab) / det };
+            Color3 b = { (bx.r * aa - ax.r * ab) / det, (bx.g * aa - ax.g * ab) / det, (bx.b * aa - ax.b * ab) / det };
+            uint16_t r0 = To565(a), r1 = To565(b);
+            uint8_t refined[16];
+            if (Fit(pixels, r0, r1, refined) < error) {
+                c0 = r0;
+                c1 = r1;
+                memcpy(indices, refined, sizeof(indices));
+            }
+        }
+        Write(c0, c1, indices, out);
+    }
+
+    inline void EncodeAlpha(const uint8_t rgba[16][4], uint8_t out[8]) {
+        int a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; i++) {
+            a0 = std::max(a0, static_cast<int>(rgba[i][3]));
+            a1 = std::min(a1, static_cast<int>(rgba[i][3]));
+        }
+        out[0] = static_cast<uint8_t>(a0);
+        out[1] = static_cast<uint8_t>(a1);
+
+        // a0 > a1 selects the 8 value mode: a0, a1, then six steps from a0 to a1
+        int palette[8] = { a0, a1 };
+        for (int i = 1; i < 7; i++) palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+        uint64_t bits = 0;
+        for (int i = 0; a0 != a1 && i < 16; i++) {
+            int best = 0;
+            for (int p = 1; p < 8; p++) {
+                if (std::abs(palette[p] - rgba[i][3]) < std::abs(palette[best] - rgba[i][3])) best = p;
+            }
+            bits |= static_cast<uint64_t>(best) << (3 * i);
+        }
+        for (int i = 0; i < 6; i++) out[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+}
+
+// --- MIP CHAIN ---
+struct Level {
+    int width;
+    int height;
+    std::vector<uint8_t> rgba;
+};
+
+// 2x2 box filter. Normal maps average the decoded vectors and renormalize.
+static Level Downsample(const Level& src, bool normalMap) {
+    Level dst = { std::max(1, src.width / 2), std::max(1, src.height / 2), {} };
+    dst.rgba.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+    for (int y = 0; y < dst.height; y++) {
+        for (int x = 0; x < dst.width; x++) {
+            float sum[4] = {};
+            for (int dy = 0; dy < 2; dy++) {
+                for (int dx = 0; dx < 2; dx++) {
+                    int sx = std::min(2 * x + dx, src.width - 1), sy = std::min(2 * y + dy, src.height - 1);
+                    const uint8_t* p = &src.rgba[(static_cast<size_t>(sy) * src.width + sx) * 4];
+                    for (int c = 0; c < 4; c++) sum[c] += normalMap && c < 3 ? p[c] / 127.5f - 1.0f : p[c] / 4.0f;
+                }
+            }
+            uint8_t* q = &dst.rgba[(static_cast<size_t>(y) * dst.width + x) * 4];
+            if (normalMap) {
+                float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+                if (length < 1e-6f) { sum[0] = sum[1] = 0.0f; sum[2] = length = 1.0f; }
+                for (int c = 0; c < 3; c++) q[c] = static_cast<uint8_t>(std::clamp((sum[c] / length + 1.0f) * 127.5f + 0.5f, 0.0f, 255.0f));
+                q[3] = static_cast<uint8_t>(sum[3] + 0.5f);
+            }
+            else {
+                for (int c = 0; c < 4; c++) q[c] = static_cast<uint8_t>(sum[c] + 0.5f);
+            }
+        }
+    }
+    return dst;
+}
+
+// Appends one level as 4x4 blocks; edge blocks repeat the last row and column.
+static void CompressLevel(const Level& level, uint32_t fourcc, std::vector<uint8_t>& out) {
+    for (int by = 0; by < level.height; by += 4) {
+        for (int bx = 0; bx < level.width; bx += 4) {
+            uint8_t block[16][4];
+            for (int i = 0; i < 16; i++) {
+                int x = std::min(bx + i % 4, level.width - 1), y = std::min(by + i / 4, level.height - 1);
+                memcpy(block[i], &level.rgba[(static_cast<size_t>(y) * level.width + x) * 4], 4);
+            }
+            uint8_t bytes[16];
+            if (fourcc == Dds::FOURCC_DXT5) {
+                Bc::EncodeAlpha(block, bytes);
+                Bc::EncodeColor(block, bytes + 8);
+            }
+            else {
+                Bc::EncodeColor(block, bytes);
+            }
+            out.insert(out.end(), bytes, bytes + Dds::BlockBytes(fourcc));
+        }
+    }
+}
+
+// --- COMPRESSOR ---
+enum class TextureKind { COLOR, NORMAL, MRA };
+
+static TextureKind KindOf(const char* path) {
+    const char* name = GetFileNameWithoutExt(path);
+    size_t length = strlen(name);
+    if (length >= 2 && strcmp(name + length - 2, "_n") == 0) return TextureKind::NORMAL;
+    if (length >= 4 && strcmp(name + length - 4, "_mra") == 0) return TextureKind::MRA;
+    return TextureKind::COLOR;
+}
+
+static std::string DdsPathFor(const char* path) {
+    std::string dds = path;
+    dds.resize(dds.size() - strlen(GetFileExtension(path)));
+    return dds + ".dds";
+}
+
+struct Totals {
+    size_t pngBytes = 0;
+    size_t rgbaBytes = 0;
+    size_t ddsBytes = 0;
+    size_t ddsFileBytes = 0;
+    int compressed = 0;
+    int skipped = 0;
+};
+
+// Writes name.dds; returns false when the texture is left as PNG.
+static bool Compress(const char* path, const std::string& ddsPath) {
+    Image image = LoadImage(path);
+    if (image.data == nullptr) return false;
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    int mipCount = Dds::MipCount(image.width, image.height);
+    if (mipCount == 0) {
+        printf("  %s: %dx%d is not a multiple of 4, left as PNG\n", path, image.width, image.height);
+        UnloadImage(image);
+        return false;
+    }
+
+    TextureKind kind = KindOf(path);
+    Level level = { image.width, image.height, {} };
+    level.rgba.assign(static_cast<uint8_t*>(image.data), static_cast<uint8_t*>(image.data) + static_cast<size_t>(image.width) * image.height * 4);
+    UnloadImage(image);
+
+    bool opaque = true;
+    for (size_t i = 3; i < level.rgba.size(); i += 4) opaque = opaque && level.rgba[i] == 255;
+    uint32_t fourcc = kind == TextureKind::NORMAL || (kind == TextureKind::COLOR && !opaque) ? Dds::FOURCC_DXT5 : Dds::FOURCC_DXT1;
+
+    Dds::Header header;
+    header.width = static_cast<uint32_t>(level.width);
+    header.height = static_cast<uint32_t>(level.height);
+    header.linearSize = static_cast<uint32_t>(Dds::LevelBytes(level.width, level.height, fourcc));
+    header.mipmapCount = static_cast<uint32_t>(mipCount);
+    header.fourcc = fourcc;
+    if (mipCount > 1) header.caps |= 0x8 | 0x400000;
+
+    std::vector<uint8_t> file(4 + sizeof(header));
+    memcpy(file.data(), "DDS ", 4);
+    memcpy(file.data() + 4, &header, sizeof(header));
+    for (int i = 0; i < mipCount; i++) {
+        if (i > 0) level = Downsample(level, kind == TextureKind::NORMAL);
+        if (kind == TextureKind::NORMAL) {
+            // DXT5nm: X to alpha, Y stays in green, red and blue unused
+            Level swizzled = level;
+            for (size_t p = 0; p < swizzled.rgba.size(); p += 4) {
+                swizzled.rgba[p + 3] = swizzled.rgba[p];
+                swizzled.rgba[p] = swizzled.rgba[p + 2] = 0;
+            }
+            CompressLevel(swizzled, fourcc, file);
+        }
+        else {
+            CompressLevel(level, fourcc, file);
+        }
+    }
+    return SaveFileData(ddsPath.c_str(), file.data(), static_cast<int>(file.size()));
+}
+
+// One report line from the PNG and the DDS on disk. "rgba8" is what the PNG
+// costs in VRAM once uploaded and mipmapped; "saved" is that minus the DDS.
+static void Report(const char* path, const std::string& ddsPath, bool fresh, Totals& totals) {
+    int ddsSize = 0;
+    unsigned char* data = LoadFileData(ddsPath.c_str(), &ddsSize);
+    if (data == nullptr || ddsSize < static_cast<int>(4 + sizeof(Dds::Header))) {
+        UnloadFileData(data);
+        return;
+    }
+    Dds::Header header;
+    memcpy(&header, data + 4, sizeof(header));
+    UnloadFileData(data);
+
+    size_t rgbaBytes = 0;
+    size_t blockBytes = 0;
+    int w = static_cast<int>(header.width), h = static_cast<int>(header.height);
+    for (uint32_t i = 0; i < std::max(header.mipmapCount, 1u); i++) {
+        rgbaBytes += static_cast<size_t>(w) * h * 4;
+        blockBytes += Dds::LevelBytes(w, h, header.fourcc);
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+    size_t pngBytes = static_cast<size_t>(GetFileLength(path));
+    printf("  %-44s %4ux%-4u %s %2u mips  png %8zu  rgba8 %9zu  dds %8zu  saved %9zu (%2.0f%%)%s\n",
+        path, header.width, header.height, header.fourcc == Dds::FOURCC_DXT5 ? "BC3" : "BC1", header.mipmapCount,
+        pngBytes, rgbaBytes, blockBytes, rgbaBytes - blockBytes, 100.0 * (rgbaBytes - blockBytes) / rgbaBytes,
+        fresh ? "" : "  (up to date)");
+    totals.pngBytes += pngBytes;
+    totals.rgbaBytes += rgbaBytes;
+    totals.ddsBytes += blockBytes;
+    totals.ddsFileBytes += static_cast<size_t>(ddsSize);
+    totals.compressed++;
+}
+
+static void Process(const char* path, bool force, Totals& totals) {
+    std::string ddsPath = DdsPathFor(path);
+    bool upToDate = !force && FileExists(ddsPath.c_str()) && GetFileModTime(ddsPath.c_str()) >= GetFileModTime(path);
+    if (upToDate || Compress(path, ddsPath)) Report(path, ddsPath, !upToDate, totals);
+    else totals.skipped++;
+}
+
+int main(int argc, char** argv) {
+    SetTraceLogLevel(LOG_WARNING);
+    bool force = false;
+    Totals totals;
+
+    if (argc < 2) {
+        printf("usage: %s [--force] <file.png | directory>...\n"
+            "  Writes a BC1/BC3 .dds with mipmaps next to each PNG; directories are not recursed.\n", argv[0]);
+        return 1;
+    }
+    printf("compressing textures\n");
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--force") == 0) {
+            force = true;
+        }
+        else if (DirectoryExists(argv[i])) {
+            FilePathList files = LoadDirectoryFiles(argv[i]);
+            std::sort(files.paths, files.paths + files.count, [](const char* a, const char* b) { return strcmp(a, b) < 0; });
+            for (unsigned int f = 0; f < files.count; f++) {
+                if (IsFileExtension(files.paths[f], ".png")) Process(files.paths[f], force, totals);
+            }
+            UnloadDirectoryFiles(files);
+        }
+        else {
+            Process(argv[i], force, totals);
+        }
+    }
+
+    if (totals.rgbaBytes > 0) {
+        printf("  %d compressed, %d left as PNG: VRAM %zu -> %zu bytes, saved %zu (%.0f%%); on disk png %zu, dds %zu\n",
+            totals.compressed, totals.skipped, totals.rgbaBytes, totals.ddsBytes, totals.rgbaBytes - totals.ddsBytes,
+            100.0 * (totals.rgbaBytes - totals.ddsBytes) / totals.rgbaBytes, totals.pngBytes, totals.ddsFileBytes);
+    }
+    return 0;
+}
@@ -2,857 +2,5817 @@
 #include <algorithm>
 #include <functional> 
 #include <memory>
+#include <cstdint>
 #include <cstdlib>
 #include <cmath>
 #include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <cerrno>
+#include <climits>
+#include <bit>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+#include <string>
+#include <optional>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 #include <raylib.h>
 #include <raymath.h>
+#include <rlgl.h>
+#include <external/stb_rect_pack.h>  // Implemented in raylib (rtext.c)
+
+// --- ALLOCATION COUNTER ---
+// Counts every global operator new so the benchmark can report heap
+// allocations per tick. raylib's own malloc calls are not included.
+// All replaceable forms (array, nothrow, aligned, sized delete) go through
+// Allocate and Release. Those are kept out of line, so the compiler never
+// pairs a new-expression with the free() inside (-Wmismatched-new-delete).
+#if defined(_MSC_VER)
+#define ALLOC_NOINLINE __declspec(noinline)
+#else
+#define ALLOC_NOINLINE __attribute__((noinline))
+#endif
+
+namespace AllocCounter {
+    inline std::atomic<uint64_t> count{ 0 };
+
+    inline uint64_t Get() {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    // 'alignment' 0: malloc's default alignment.
+    ALLOC_NOINLINE inline void* Allocate(size_t size, size_t alignment) noexcept {
+        count.fetch_add(1, std::memory_order_relaxed);
+        if (size == 0) size = 1;
+        if (alignment == 0) return malloc(size);
+#if defined(_MSC_VER)
+        return _aligned_malloc(size, alignment);
+#else
+        return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    }
+
+    ALLOC_NOINLINE inline void Release(void* p, size_t alignment) noexcept {
+#if defined(_MSC_VER)
+        if (alignment != 0) {
+            _aligned_free(p);
+            return;
+        }
+#endif
+        (void)alignment;
+        free(p);
+    }
+
+    inline void* AllocateOrThrow(size_t size, size_t alignment) {
+        if (void* p = Allocate(size, alignment)) return p;
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(size_t size) { return AllocCounter::AllocateOrThrow(size, 0); }
+void* operator new[](size_t size) { return AllocCounter::AllocateOrThrow(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return AllocCounter::Allocate(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return AllocCounter::Allocate(size, 0); }
+void* operator new(size_t size, std::align_val_t align) { return AllocCounter::AllocateOrThrow(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return AllocCounter::AllocateOrThrow(size, static_cast<size_t>(align)); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return AllocCounter::Allocate(size, static_cast<size_t>(align));
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return AllocCounter::Allocate(size, static_cast<size_t>(align));
+}
+
+void operator delete(void* p) noexcept { AllocCounter::Release(p, 0); }
+void operator delete[](void* p) noexcept { AllocCounter::Release(p, 0); }
+void operator delete(void* p, size_t) noexcept { AllocCounter::Release(p, 0); }
+void operator delete[](void* p, size_t) noexcept { AllocCounter::Release(p, 0); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { AllocCounter::Release(p, 0); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { AllocCounter::Release(p, 0); }
+void operator delete(void* p, std::align_val_t align) noexcept { AllocCounter::Release(p, static_cast<size_t>(align)); }
+void operator delete[](void* p, std::align_val_t align) noexcept { AllocCounter::Release(p, static_cast<size_t>(align)); }
+void operator delete(void* p, size_t, std::align_val_t align) noexcept { AllocCounter::Release(p, static_cast<size_t>(align)); }
+void operator delete[](void* p, size_t, std::align_val_t align) noexcept { AllocCounter::Release(p, static_cast<size_t>(align)); }
+void operator delete(void* p, std::align_val_t align, const std::nothrow_t&) noexcept {
+    AllocCounter::Release(p, static_cast<size_t>(align));
+}
+void operator delete[](void* p, std::align_val_t align, const std::nothrow_t&) noexcept {
+    AllocCounter::Release(p, static_cast<size_t>(align));
+}
+
+// --- PROFILER ---
+// Scoped timing zones: PROFILE_ZONE("name") times the rest of the enclosing
+// block. Each thread appends closed zones to its own ring, so recording takes
+// no lock; the overlay and the trace exporters read the rings between frames,
+// while no other thread is recording. Built into debug builds and profile
+// builds (PROFILE defined); in release builds the macros expand to nothing and
+// the overlay and exporters are empty stubs.
+#if !defined(PROFILER_ENABLED)
+#if defined(_DEBUG) || defined(PROFILE)
+#define PROFILER_ENABLED 1
+#else
+#define PROFILER_ENABLED 0
+#endif
+#endif
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if PROFILER_ENABLED
+#define PROFILE_ZONE(name) Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_THREAD(...) Profiler::Registry::Instance().Current().SetName(__VA_ARGS__)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_THREAD(...) ((void)0)
+#endif
+
+namespace Profiler {
+    constexpr bool ENABLED = PROFILER_ENABLED;
+
+#if PROFILER_ENABLED
+    inline int64_t Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    struct ZoneEvent {
+        const char* name;  // String literal
+        int64_t startNs;
+        int64_t endNs;
+        int32_t depth;     // Zones open around this one on the same thread
+    };
+
+    // Closed zones of one thread, oldest overwritten first. Only the owning
+    // thread writes.
+    class ThreadLog {
+    public:
+        static constexpr uint64_t CAPACITY = 1 << 17;
+
+        explicit ThreadLog(int id)
+            : events(std::make_unique<ZoneEvent[]>(CAPACITY)), id(id) {
+            SetName("thread", id);
+        }
+
+        void Push(const ZoneEvent& event) {
+            uint64_t n = written.load(std::memory_order_relaxed);
+            events[n & (CAPACITY - 1)] = event;
+            written.store(n + 1, std::memory_order_release);
+        }
+
+        // Events [First(), Written()) are still in the ring.
+        uint64_t First() const {
+            uint64_t n = Written();
+            return n > CAPACITY ? n - CAPACITY : 0;
+        }
+
+        uint64_t Written() const {
+            return written.load(std::memory_order_acquire);
+        }
+
+        const ZoneEvent& At(uint64_t i) const {
+            return events[i & (CAPACITY - 1)];
+        }
+
+        void SetName(const char* base, int index = -1) {
+            if (index >= 0) snprintf(name, sizeof(name), "%s %d", base, index);
+            else snprintf(name, sizeof(name), "%s", base);
+        }
+
+        const char* Name() const {
+            return name;
+        }
+
+        int Id() const {
+            return id;
+        }
+
+        int32_t depth = 0;
+
+    private:
+        std::unique_ptr<ZoneEvent[]> events;
+        std::atomic<uint64_t> written{ 0 };
+        int id;
+        char name[32] = {};
+    };
+
+    class Registry {
+    public:
+        static Registry& Instance() {
+            static Registry instance;
+            return instance;
+        }
+
+        // Log of the calling thread, created on its first zone.
+        ThreadLog& Current() {
+            if (!current) {
+                std::lock_guard<std::mutex> lock(mutex);
+                logs.push_back(std::make_unique<ThreadLog>(static_cast<int>(logs.size())));
+                current = logs.back().get();
+            }
+            return *current;
+        }
+
+        // Chrome trace-event JSON (chrome://tracing, Perfetto), one complete
+        // event per zone with times in microseconds since start-up.
+        bool ExportChromeTrace(const char* path) {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::vector<char> out;
+            Append(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+            for (const auto& log : logs) {
+                Append(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    log.get() == logs.front().get() ? "" : ",\n", log->Id(), log->Name());
+                for (uint64_t i = log->First(), end = log->Written(); i < end; i++) {
+                    const ZoneEvent& e = log->At(i);
+                    Append(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                        e.name, log->Id(), (e.startNs - epoch) / 1000.0, (e.endNs - e.startNs) / 1000.0);
+                }
+            }
+            Append(out, "\n]}\n");
+            return SaveFileData(path, out.data(), static_cast<int>(out.size()));
+        }
+
+        // One row per zone: thread, zone, depth, start_us, duration_us.
+        bool ExportCsv(const char* path) {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::vector<char> out;
+            Append(out, "thread,zone,depth,start_us,duration_us\n");
+            for (const auto& log : logs) {
+                for (uint64_t i = log->First(), end = log->Written(); i < end; i++) {
+                    const ZoneEvent& e = log->At(i);
+                    Append(out, "%s,%s,%d,%.3f,%.3f\n", log->Name(), e.name, e.depth,
+                        (e.startNs - epoch) / 1000.0, (e.endNs - e.startNs) / 1000.0);
+                }
+            }
+            return SaveFileData(path, out.data(), static_cast<int>(out.size()));
+        }
+
+    private:
+        Registry() : epoch(Now()) {}
+
+        template <typename... Args>
+        static void Append(std::vector<char>& out, const char* format, Args... args) {
+            char line[256];
+            int length = snprintf(line, sizeof(line), format, args...);
+            out.insert(out.end(), line, line + std::clamp(length, 0, static_cast<int>(sizeof(line)) - 1));
+        }
+
+        static inline thread_local ThreadLog* current = nullptr;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadLog>> logs;
+        int64_t epoch;
+    };
+
+    class Zone {
+    public:
+        explicit Zone(const char* name)
+            : log(Registry::Instance().Current()), name(name), depth(log.depth++), start(Now()) {}
+
+        ~Zone() {
+            int64_t end = Now();
+            log.depth--;
+            log.Push({ name, start, end, depth });
+        }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        ThreadLog& log;
+        const char* name;
+        int32_t depth;
+        int64_t start;
+    };
+
+    // Time per zone over the calling thread's last FRAMES frames, drawn as a
+    // tree of rolling graphs.
+    class FrameHistory {
+    public:
+        static constexpr int FRAMES = 120;
+        static constexpr int MAX_ZONES = 48;
+        static constexpr int MAX_EVENTS = 4096;  // Per frame; later ones are not shown
+
+        // Folds the zones closed since the previous call into a new frame.
+        void EndFrame() {
+            const ThreadLog& log = Registry::Instance().Current();
+            int64_t now = Now();
+
+            // The log is in closing order; walk the frame in opening order so
+            // every zone's parent has been placed before it.
+            uint64_t begin = std::max(cursor, log.First());
+            uint64_t end = std::min(log.Written(), begin + MAX_EVENTS);
+            int count = 0;
+            for (uint64_t i = begin; i < end; i++) {
+                frameEvents[count++] = &log.At(i);
+            }
+            std::sort(frameEvents, frameEvents + count, [](const ZoneEvent* a, const ZoneEvent* b) {
+                return a->startNs < b->startNs;
+            });
+            int open[64];  // Zone at each depth; -2 when unknown (parent outside this frame)
+            std::fill(std::begin(open), std::end(open), -2);
+            for (int i = 0; i < count; i++) {
+                const ZoneEvent& e = *frameEvents[i];
+                if (e.depth >= 64) continue;
+                int parent = e.depth > 0 ? open[e.depth - 1] : -1;
+                int zone = parent >= -1 ? Find(e.name, parent, e.depth) : -2;
+                open[e.depth] = zone;
+                if (zone >= 0) zones[zone].current += static_cast<float>(e.endNs - e.startNs) * 1e-6f;
+            }
+            cursor = log.Written();
+
+            frameMs[head] = frameStart != 0 ? static_cast<float>(now - frameStart) * 1e-6f : 0.f;
+            frameStart = now;
+            for (int z = 0; z < zoneCount; z++) {
+                zones[z].ms[head] = zones[z].current;
+                zones[z].current = 0.f;
+            }
+            head = (head + 1) % FRAMES;
+            frames = std::min(frames + 1, FRAMES);
+        }
+
+        void Draw(int x, int y) const {
+            constexpr int width = 470;
+            constexpr int rowHeight = 16;
+            constexpr int graphX = 320;
+            DrawRectangle(x, y, width, 44 + zoneCount * rowHeight, Fade(BLACK, 0.75f));
+
+            // Frame time against the 60 Hz budget
+            constexpr float budgetMs = 1000.f / 60.f;
+            float frameAvg = 0.f, frameMax = 0.f;
+            Stats(frameMs, frameAvg, frameMax);
+            float frameScale = std::max(frameMax, budgetMs);
+            int budgetY = y + 34 - static_cast<int>(30.f * budgetMs / frameScale);
+            DrawText(TextFormat("Frame  avg %.2f  max %.2f ms", frameAvg, frameMax), x + 6, y + 6, 10, WHITE);
+            DrawText("zone", x + 6, y + 24, 10, GRAY);
+            DrawText("avg ms  max ms", x + 200, y + 24, 10, GRAY);
+            DrawGraph(frameMs, x + graphX, y + 4, 30, frameScale, SKYBLUE);
+            DrawLine(x + graphX, budgetY, x + graphX + FRAMES, budgetY, RED);
+
+            int rowY = y + 40;
+            for (int row = 0; row < zoneCount; row++, rowY += rowHeight) {
+                const ZoneHistory& zone = zones[order[row]];
+                float avg = 0.f, max = 0.f;
+                Stats(zone.ms, avg, max);
+                DrawText(zone.name, x + 6 + zone.depth * 10, rowY, 10, LIGHTGRAY);
+                DrawText(TextFormat("%6.3f %6.3f", avg, max), x + 200, rowY, 10, LIGHTGRAY);
+                DrawGraph(zone.ms, x + graphX, rowY, rowHeight - 3, std::max(max, 0.001f), GREEN);
+            }
+        }
+
+    private:
+        struct ZoneHistory {
+            const char* name;
+            int parent;  // Index in 'zones', -1 at the top level
+            int depth;
+            float current;
+            float ms[FRAMES];
+        };
+
+        // Zone 'name' under 'parent', added after the parent's other children
+        // when it is new. -2 once the table is full.
+        int Find(const char* name, int parent, int depth) {
+            for (int z = 0; z < zoneCount; z++) {
+                if (zones[z].name == name && zones[z].parent == parent) return z;
+            }
+            if (zoneCount == MAX_ZONES) return -2;
+
+            int row = zoneCount;
+            if (parent >= 0) {
+                row = 0;
+                while (order[row] != parent) row++;
+                for (row++; row < zoneCount && zones[order[row]].depth > depth - 1; row++) {}
+            }
+            for (int r = zoneCount; r > row; r--) {
+                order[r] = order[r - 1];
+            }
+            zones[zoneCount] = { name, parent, depth, 0.f, {} };
+            order[row] = zoneCount;
+            return zoneCount++;
+        }
+
+        void Stats(const float (&ms)[FRAMES], float& avg, float& max) const {
+            float sum = 0.f;
+            max = 0.f;
+            for (int i = 0; i < frames; i++) {
+                sum += ms[i];
+                max = std::max(max, ms[i]);
+            }
+            avg = frames > 0 ? sum / frames : 0.f;
+        }
+
+        // Oldest frame on the left.
+        void DrawGraph(const float (&ms)[FRAMES], int x, int y, int height, float scale, Color color) const {
+            for (int i = 0; i < frames; i++) {
+                float value = ms[(head + FRAMES - frames + i) % FRAMES];
+                int h = std::min(height, static_cast<int>(value / scale * height + 0.5f));
+                if (h > 0) DrawRectangle(x + FRAMES - frames + i, y + height - h, 1, h, color);
+            }
+        }
+
+        ZoneHistory zones[MAX_ZONES] = {};
+        int order[MAX_ZONES] = {};  // Display order: every zone below its parent
+        int zoneCount = 0;
+        const ZoneEvent* frameEvents[MAX_EVENTS] = {};
+        float frameMs[FRAMES] = {};
+        int head = 0;
+        int frames = 0;
+        int64_t frameStart = 0;
+        uint64_t cursor = 0;
+    };
+#else
+    class FrameHistory {
+    public:
+        void EndFrame() {}
+        void Draw(int, int) const {}
+    };
+
+    class Registry {
+    public:
+        static Registry& Instance() {
+            static Registry instance;
+            return instance;
+        }
+
+        bool ExportChromeTrace(const char*) { return false; }
+        bool ExportCsv(const char*) { return false; }
+    };
+#endif
+}
+
+// --- SIMD KERNELS ---
+// Batch integration and off-screen rejection over SoA columns, 8 entities per
+// AVX2 instruction when the build targets it (build.bat: /arch:AVX2), with a
+// scalar path for other targets and for comparison at runtime (F2). The same
+// switch selects RandomStream's bulk fills.
+namespace Kernels {
+    inline bool useSimd = true;
+
+    // Entities per parallel chunk. A multiple of 8, so each chunk owns whole
+    // bytes of a CullOutside mask.
+    constexpr size_t CHUNK = 2048;
+
+    // p[i] += v[i] * dt
+    inline void Integrate(float* p, const float* v, size_t n, float dt) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        if (useSimd) {
+            __m256 vdt = _mm256_set1_ps(dt);
+            for (; i + 8 <= n; i += 8) {
+                __m256 step = _mm256_mul_ps(_mm256_loadu_ps(v + i), vdt);
+                _mm256_storeu_ps(p + i, _mm256_add_ps(_mm256_loadu_ps(p + i), step));
+            }
+        }
+#endif
+        for (; i < n; i++) {
+            p[i] += v[i] * dt;
+        }
+    }
+
+    // Writes a dead mask (bit i%8 of dead[i/8]) for every circle (x, y, r) lying
+    // completely outside [minX, maxX] x [minY, maxY]. r may be null for points.
+    // Returns the number of dead entities.
+    inline size_t CullOutside(const float* x, const float* y, const float* r, size_t n,
+        float minX, float minY, float maxX, float maxY, uint8_t* dead)
+    {
+        size_t i = 0;
+        size_t count = 0;
+#if defined(__AVX2__)
+        if (useSimd) {
+            __m256 vMinX = _mm256_set1_ps(minX), vMaxX = _mm256_set1_ps(maxX);
+            __m256 vMinY = _mm256_set1_ps(minY), vMaxY = _mm256_set1_ps(maxY);
+            for (; i + 8 <= n; i += 8) {
+                __m256 vr = r ? _mm256_loadu_ps(r + i) : _mm256_setzero_ps();
+                __m256 vx = _mm256_loadu_ps(x + i);
+                __m256 vy = _mm256_loadu_ps(y + i);
+                __m256 out = _mm256_or_ps(
+                    _mm256_or_ps(_mm256_cmp_ps(vx, _mm256_sub_ps(vMinX, vr), _CMP_LT_OQ),
+                                 _mm256_cmp_ps(vx, _mm256_add_ps(vMaxX, vr), _CMP_GT_OQ)),
+                    _mm256_or_ps(_mm256_cmp_ps(vy, _mm256_sub_ps(vMinY, vr), _CMP_LT_OQ),
+                                 _mm256_cmp_ps(vy, _mm256_add_ps(vMaxY, vr), _CMP_GT_OQ)));
+                unsigned bits = static_cast<unsigned>(_mm256_movemask_ps(out));
+                dead[i / 8] = static_cast<uint8_t>(bits);
+                count += std::popcount(bits);
+            }
+        }
+#endif
+        for (; i < n; i += 8) {
+            unsigned bits = 0;
+            size_t end = std::min(n, i + 8);
+            for (size_t j = i; j < end; j++) {
+                float m = r ? r[j] : 0.f;
+                bool out = x[j] < minX - m || x[j] > maxX + m || y[j] < minY - m || y[j] > maxY + m;
+                bits |= static_cast<unsigned>(out) << (j - i);
+            }
+            dead[i / 8] = static_cast<uint8_t>(bits);
+            count += std::popcount(bits);
+        }
+        return count;
+    }
+}
+
+// --- RANDOM ---
+// Counter-based generator (Widynski's "Squares"): value = f(key, counter) with
+// no hidden state, so any range of a stream can be produced independently - in
+// bulk, out of order or split across threads - and still match bit for bit.
+class RandomStream {
+public:
+    explicit RandomStream(uint64_t key = 1, uint64_t counter = 0) : key(key), counter(counter) {}
+
+    static uint32_t At(uint64_t key, uint64_t ctr) {
+        uint64_t x = ctr * key;
+        uint64_t y = x;
+        uint64_t z = y + key;
+        x = x * x + y; x = (x >> 32) | (x << 32);
+        x = x * x + z; x = (x >> 32) | (x << 32);
+        x = x * x + y; x = (x >> 32) | (x << 32);
+        return static_cast<uint32_t>((x * x + z) >> 32);
+    }
+
+    uint32_t NextU32() {
+        return At(key, counter++);
+    }
+
+    // Uniform in [min, max), built from the top 24 bits so it is exact in float.
+    float NextFloat(float min, float max) {
+        return min + static_cast<float>(NextU32() >> 8) * (1.f / 16777216.f) * (max - min);
+    }
+
+    // Inclusive range, like raylib's GetRandomValue.
+    int NextInt(int min, int max) {
+        uint64_t span = static_cast<uint64_t>(static_cast<int64_t>(max) - min + 1);
+        return min + static_cast<int>((NextU32() * span) >> 32);
+    }
+
+    // Fill out[0..n) from counters [Counter(), Counter() + n) and advance past
+    // them. No element depends on another, so the loop carries no state.
+    void FillFloats(float* out, size_t n, float min, float max) {
+        FillFloatsAt(key, counter, out, n, min, max);
+        counter += n;
+    }
+
+    void FillInts(int* out, size_t n, int min, int max) {
+        FillIntsAt(key, counter, out, n, min, max);
+        counter += n;
+    }
+
+    // Stateless variants for splitting one reserved range (see Skip) across
+    // threads. With AVX2, 8 counters per step; bit for bit the scalar result.
+    static void FillFloatsAt(uint64_t key, uint64_t firstCounter, float* out, size_t n, float min, float max) {
+        float scale = (max - min) * (1.f / 16777216.f);
+        size_t i = 0;
+#if defined(__AVX2__)
+        if (Kernels::useSimd) {
+            __m256 vMin = _mm256_set1_ps(min), vScale = _mm256_set1_ps(scale);
+            for (; i + 8 <= n; i += 8) {
+                __m256i bits = _mm256_srli_epi32(At8(key, firstCounter + i), 8);
+                // Multiply, then add: no FMA, so the rounding matches the scalar loop
+                __m256 value = _mm256_add_ps(vMin, _mm256_mul_ps(_mm256_cvtepi32_ps(bits), vScale));
+                _mm256_storeu_ps(out + i, value);
+            }
+        }
+#endif
+        for (; i < n; i++) {
+            out[i] = min + static_cast<float>(At(key, firstCounter + i) >> 8) * scale;
+        }
+    }
+
+    static void FillIntsAt(uint64_t key, uint64_t firstCounter, int* out, size_t n, int min, int max) {
+        uint64_t span = static_cast<uint64_t>(static_cast<int64_t>(max) - min + 1);
+        size_t i = 0;
+#if defined(__AVX2__)
+        if (Kernels::useSimd && span <= UINT32_MAX) {
+            __m256i vMin = _mm256_set1_epi32(min), vSpan = _mm256_set1_epi64x(static_cast<int64_t>(span));
+            for (; i + 8 <= n; i += 8) {
+                __m256i lo, hi;
+                At4x2(key, firstCounter + i, lo, hi);
+                // (value * span) >> 32 per lane, values in the high halves
+                lo = _mm256_mul_epu32(_mm256_srli_epi64(lo, 32), vSpan);
+                hi = _mm256_mul_epu32(_mm256_srli_epi64(hi, 32), vSpan);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(vMin, PackHigh(lo, hi)));
+            }
+        }
+#endif
+        for (; i < n; i++) {
+            out[i] = min + static_cast<int>((At(key, firstCounter + i) * span) >> 32);
+        }
+    }
+
+    // Reserves the next n values and returns the first counter of the range.
+    uint64_t Skip(uint64_t n) {
+        uint64_t first = counter;
+        counter += n;
+        return first;
+    }
+
+    uint64_t Key() const {
+        return key;
+    }
+
+    uint64_t Counter() const {
+        return counter;
+    }
+
+private:
+#if defined(__AVX2__)
+    // Low 64 bits of a * b per lane; AVX2 only multiplies 32 x 32 bits.
+    static __m256i Mul64(__m256i a, __m256i b) {
+        __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)),
+                                         _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b));
+        return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+    }
+
+    // x * x + add, then the halves swapped: one Squares round per lane.
+    static __m256i Round(__m256i x, __m256i add) {
+        __m256i square = _mm256_add_epi64(_mm256_mul_epu32(x, x),
+                                          _mm256_slli_epi64(_mm256_mul_epu32(x, _mm256_srli_epi64(x, 32)), 33));
+        return _mm256_shuffle_epi32(_mm256_add_epi64(square, add), _MM_SHUFFLE(2, 3, 0, 1));
+    }
+
+    // Squares before the final shift, counters ctr..ctr+3 in 'lo' and
+    // ctr+4..ctr+7 in 'hi'; At() is the high half of each lane.
+    static void At4x2(uint64_t key, uint64_t ctr, __m256i& lo, __m256i& hi) {
+        __m256i vKey = _mm256_set1_epi64x(static_cast<int64_t>(key));
+        __m256i base = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<int64_t>(ctr)), _mm256_setr_epi64x(0, 1, 2, 3));
+        __m256i counters[2] = { base, _mm256_add_epi64(base, _mm256_set1_epi64x(4)) };
+        for (__m256i& x : counters) {
+            __m256i y = Mul64(x, vKey);
+            __m256i z = _mm256_add_epi64(y, vKey);
+            x = Round(Round(Round(y, y), z), y);
+            x = _mm256_add_epi64(Mul64(x, x), z);
+        }
+        lo = counters[0];
+        hi = counters[1];
+    }
+
+    // High halves of the lanes of 'lo' then 'hi', as 8 x 32 bits in order.
+    static __m256i PackHigh(__m256i lo, __m256i hi) {
+        __m256i mixed = _mm256_blend_epi32(_mm256_srli_epi64(lo, 32), hi, 0xAA);  // lo0 hi0 lo1 hi1 ...
+        return _mm256_permutevar8x32_epi32(mixed, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+    }
+
+    // At(key, ctr + i) for i in 0..7.
+    static __m256i At8(uint64_t key, uint64_t ctr) {
+        __m256i lo, hi;
+        At4x2(key, ctr, lo, hi);
+        return PackHigh(lo, hi);
+    }
+#endif
+
+    uint64_t key;
+    uint64_t counter;
+};
+
+// One stream per system, all derived from the session seed, so extra draws in
+// one system never shift the sequence another system sees.
+enum class RandomStreamId { SPAWN, DROPS, EFFECTS, BENCH, COUNT };
+
+class Random {
+public:
+    static Random& Instance() {
+        static Random inst;
+        return inst;
+    }
+
+    void Seed(uint64_t seed) {
+        sessionSeed = seed;
+        for (int i = 0; i < static_cast<int>(RandomStreamId::COUNT); i++) {
+            streams[i] = RandomStream(MakeKey(seed, i));
+        }
+    }
+
+    uint64_t GetSeed() const {
+        return sessionSeed;
+    }
+
+    RandomStream& Stream(RandomStreamId id) {
+        return streams[static_cast<int>(id)];
+    }
+
+private:
+    Random() {
+        Seed(0);
+    }
+
+    // splitmix64 of (seed, stream): Squares needs keys with well-mixed bits.
+    static uint64_t MakeKey(uint64_t seed, int stream) {
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull * static_cast<uint64_t>(stream + 1);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        return z | 1;
+    }
+
+    uint64_t sessionSeed = 0;
+    RandomStream streams[static_cast<int>(RandomStreamId::COUNT)];
+};
+
+// --- TRANSFORM, RENDERABLE ---
+struct TransformA {
+    Vector2 position{};
+    float rotation{};
+};
+
+struct Renderable {
+    enum Size { SMALL = 1, MEDIUM = 2, LARGE = 4 } size = SMALL;
+};
+
+// --- ASSET CACHE ---
+// GPU assets shared by path with reference counts. The first Acquire loads an
+// asset; later ones only bump its count, so recreating an entity does no I/O.
+// The asset is unloaded when its last reference is released. Assets in a
+// preload manifest hold a reference of their own until ReleasePreloaded.
+enum class AssetType : uint8_t { TEXTURE, FONT, SHADER, MODEL };
+
+struct AssetManifestEntry {
+    AssetType   type;
+    const char* path;                    // Vertex shader for SHADER, may be null
+    const char* fragmentPath = nullptr;  // SHADER only
+    bool        mipmaps = false;         // TEXTURE only
+    int         filter = TEXTURE_FILTER_POINT;
+};
+
+// Typed so a texture handle cannot be passed where a model is expected.
+template <typename T>
+struct AssetHandle {
+    uint32_t slot = 0;  // 1-based, 0 = no asset
+    uint32_t generation = 0;
+
+    bool Valid() const {
+        return slot != 0;
+    }
+};
+
+using TextureHandle = AssetHandle<Texture2D>;
+using FontHandle    = AssetHandle<Font>;
+using ShaderHandle  = AssetHandle<Shader>;
+using ModelHandle   = AssetHandle<Model>;
+
+struct AssetStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    int      resident = 0;
+    size_t   bytes = 0;  // Estimated GPU memory of the resident assets
+};
+
+inline bool AssetLoaded(const Texture2D& t) { return t.id != 0; }
+inline bool AssetLoaded(const Font& f)      { return f.texture.id != 0 && f.glyphs != nullptr; }
+inline bool AssetLoaded(const Shader& s)    { return s.id != 0 && s.id != rlGetShaderIdDefault(); }
+inline bool AssetLoaded(const Model& m)     { return m.meshCount > 0 && m.meshes != nullptr; }
+
+inline void UnloadAsset(Texture2D& t) { UnloadTexture(t); }
+inline void UnloadAsset(Font& f)      { UnloadFont(f); }
+inline void UnloadAsset(Shader& s)    { UnloadShader(s); }
+inline void UnloadAsset(Model& m)     { UnloadModel(m); }
+
+inline size_t AssetBytes(const Texture2D& t) {
+    size_t base = static_cast<size_t>(GetPixelDataSize(t.width, t.height, t.format));
+    return t.mipmaps > 1 ? base + base / 3 : base;
+}
+inline size_t AssetBytes(const Font& f) {
+    return AssetBytes(f.texture) + static_cast<size_t>(f.glyphCount) * (sizeof(GlyphInfo) + sizeof(Rectangle));
+}
+inline size_t AssetBytes(const Shader&) { return 0; }
+inline size_t AssetBytes(const Model& m) {
+    size_t bytes = 0;
+    for (int i = 0; i < m.meshCount; i++) {
+        const Mesh& mesh = m.meshes[i];
+        bytes += static_cast<size_t>(mesh.vertexCount) * (8 * sizeof(float) + (mesh.colors ? 4 : 0));
+        if (mesh.indices) bytes += static_cast<size_t>(mesh.triangleCount) * 3 * sizeof(unsigned short);
+    }
+    return bytes;
+}
+
+// Loaded assets of one type. Lookups compare a hash of the path; there are
+// few enough assets for a linear scan.
+template <typename T>
+class AssetPool {
+public:
+    template <typename Load>
+    AssetHandle<T> Acquire(uint64_t key, const char* name, AssetStats& stats, Load&& load) {
+        for (uint32_t i = 0; i < entries.size(); i++) {
+            Entry& e = entries[i];
+            if (e.refs > 0 && e.key == key) {
+                e.refs++;
+                stats.hits++;
+                return { i + 1, e.generation };
+            }
+        }
+
+        stats.misses++;
+        T asset = load();
+        if (!AssetLoaded(asset)) {
+            TraceLog(LOG_WARNING, "ASSETS: could not load %s", name);
+            return {};
+        }
+        uint32_t slot = 0;
+        while (slot < entries.size() && entries[slot].refs > 0) slot++;
+        if (slot == entries.size()) entries.emplace_back();
+
+        Entry& e = entries[slot];
+        e.key = key;
+        e.name = name;
+        e.asset = asset;
+        e.refs = 1;
+        e.generation++;
+        e.bytes = AssetBytes(asset);
+        stats.resident++;
+        stats.bytes += e.bytes;
+        return { slot + 1, e.generation };
+    }
+
+    const T& Get(AssetHandle<T> handle) const {
+        return entries[handle.slot - 1].asset;
+    }
+
+    // Drops the reference and clears 'handle'; the last one unloads the asset.
+    void Release(AssetHandle<T>& handle, AssetStats& stats) {
+        if (!handle.Valid()) return;
+        Entry& e = entries[handle.slot - 1];
+        uint32_t generation = handle.generation;
+        handle = {};
+        if (e.generation != generation || e.refs == 0 || --e.refs > 0) return;
+        UnloadAsset(e.asset);
+        e.asset = {};
+        stats.resident--;
+        stats.bytes -= e.bytes;
+    }
+
+    // Assets still referenced, for the shutdown check.
+    template <typename F>
+    void ForEachReferenced(F&& fn) const {
+        for (const Entry& e : entries) {
+            if (e.refs > 0) fn(e.name.c_str(), e.refs);
+        }
+    }
+
+private:
+    struct Entry {
+        uint64_t    key = 0;
+        std::string name;
+        T           asset = {};
+        int         refs = 0;
+        uint32_t    generation = 0;
+        size_t      bytes = 0;
+    };
+
+    std::vector<Entry> entries;
+};
+
+class AssetCache {
+public:
+    static AssetCache& Instance() {
+        static AssetCache inst;
+        return inst;
+    }
+
+    // Loads every entry and keeps it resident until ReleasePreloaded.
+    void Preload(const AssetManifestEntry* manifest, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            const AssetManifestEntry& entry = manifest[i];
+            switch (entry.type) {
+            case AssetType::TEXTURE: Pin(AcquireTexture(entry.path, entry.mipmaps, entry.filter)); break;
+            case AssetType::FONT:    Pin(AcquireFont(entry.path)); break;
+            case AssetType::SHADER:  Pin(AcquireShader(entry.path, entry.fragmentPath)); break;
+            case AssetType::MODEL:   Pin(AcquireModel(entry.path)); break;
+            }
+        }
+    }
+
+    // Drops the manifest's references and reports anything still held.
+    void ReleasePreloaded() {
+        for (TextureHandle& h : pinnedTextures) Release(h);
+        for (FontHandle& h : pinnedFonts) Release(h);
+        for (ShaderHandle& h : pinnedShaders) Release(h);
+        for (ModelHandle& h : pinnedModels) Release(h);
+        pinnedTextures.clear();
+        pinnedFonts.clear();
+        pinnedShaders.clear();
+        pinnedModels.clear();
+
+        auto leak = [](const char* name, int refs) {
+            TraceLog(LOG_WARNING, "ASSETS: %s still has %d reference(s)", name, refs);
+        };
+        textures.ForEachReferenced(leak);
+        fonts.ForEachReferenced(leak);
+        shaders.ForEachReferenced(leak);
+        models.ForEachReferenced(leak);
+    }
+
+    // GPU assets need a window; without one these return an empty handle.
+    // Mipmaps and filter apply when the texture is loaded, not on later hits.
+    // A texture's compressed .dds (see CompressTextures.cpp) is used when present.
+    TextureHandle AcquireTexture(const char* path, bool mipmaps = false, int filter = TEXTURE_FILTER_POINT) {
+        if (!IsWindowReady()) return {};
+        return textures.Acquire(Key(path), path, stats, [&] {
+            Texture2D texture = LoadCompressedTexture(path, mipmaps);
+            if (texture.id == 0) {
+                texture = LoadTexture(path);
+                if (texture.id != 0 && mipmaps) GenTextureMipmaps(&texture);
+            }
+            if (texture.id != 0) SetTextureFilter(texture, filter);
+            return texture;
+        });
+    }
+
+    FontHandle AcquireFont(const char* path) {
+        if (!IsWindowReady()) return {};
+        return fonts.Acquire(Key(path), path, stats, [&] { return LoadFont(path); });
+    }
+
+    ShaderHandle AcquireShader(const char* vsPath, const char* fsPath) {
+        if (!IsWindowReady()) return {};
+        const char* name = fsPath ? fsPath : vsPath;
+        return shaders.Acquire(Key(vsPath, fsPath), name ? name : "default shader", stats,
+            [&] { return LoadShader(vsPath, fsPath); });
+    }
+
+    ModelHandle AcquireModel(const char* path) {
+        if (!IsWindowReady()) return {};
+        return models.Acquire(Key(path), path, stats, [&] { return LoadModel(path); });
+    }
+
+    template <typename T>
+    const T& Get(AssetHandle<T> handle) const {
+        return PoolOf<T>().Get(handle);
+    }
+
+    template <typename T>
+    void Release(AssetHandle<T>& handle) {
+        PoolOf<T>().Release(handle, stats);
+    }
 
-// --- UTILS ---
-namespace Utils {
-    inline static float RandomFloat(float min, float max) {
-        return min + static_cast<float>(rand()) / RAND_MAX * (max - min);
+    const AssetStats& Stats() const {
+        return stats;
+    }
+
+private:
+    AssetCache() = default;
+
+    // Loads name.dds in place of name.png when it is at least as new and holds
+    // mipmaps if they are wanted. raylib's DDS reader keeps only the first level
+    // of a compressed file, so the header is read here. Returns an empty texture
+    // when the PNG should be used instead, including when the GPU has no BC support.
+    static Texture2D LoadCompressedTexture(const char* path, bool mipmaps) {
+        std::string ddsPath = path;
+        ddsPath.resize(ddsPath.size() - strlen(GetFileExtension(path)));
+        ddsPath += ".dds";
+        if (!FileExists(ddsPath.c_str())) return {};
+        if (FileExists(path) && GetFileModTime(ddsPath.c_str()) < GetFileModTime(path)) return {};
+
+        constexpr int HEADER_BYTES = 128;  // "DDS " and the 124 byte header
+        int size = 0;
+        unsigned char* data = LoadFileData(ddsPath.c_str(), &size);
+        if (data == nullptr) return {};
+        uint32_t field[32] = {};
+        if (size >= HEADER_BYTES) memcpy(field, data, sizeof(field));
+
+        // field[3]: height, [4]: width, [7]: mip count, [21]: fourcc
+        Image image = { data, static_cast<int>(field[4]), static_cast<int>(field[3]), std::max(1, static_cast<int>(field[7])), 0 };
+        if (field[21] == 0x31545844) image.format = PIXELFORMAT_COMPRESSED_DXT1_RGB;        // "DXT1"
+        else if (field[21] == 0x35545844) image.format = PIXELFORMAT_COMPRESSED_DXT5_RGBA;  // "DXT5"
+        if (!mipmaps) image.mipmaps = 1;
+
+        int payload = 0;
+        for (int i = 0, w = image.width, h = image.height; image.format != 0 && i < image.mipmaps; i++) {
+            payload += GetPixelDataSize(w, h, image.format);
+            w = std::max(1, w / 2);
+            h = std::max(1, h / 2);
+        }
+        bool usable = memcmp(data, "DDS ", 4) == 0 && image.format != 0 && image.width > 0 && image.height > 0
+            && (!mipmaps || image.mipmaps > 1) && payload <= size - HEADER_BYTES;
+        if (!usable) {
+            UnloadFileData(data);
+            return {};
+        }
+
+        // Move the levels to the start of the buffer so the image owns it.
+        memmove(data, data + HEADER_BYTES, static_cast<size_t>(payload));
+        Texture2D texture = LoadTextureFromImage(image);
+        UnloadImage(image);
+        return texture;
+    }
+
+    // 64-bit FNV-1a of the path(s).
+    static uint64_t Key(const char* path, const char* second = nullptr) {
+        uint64_t h = 0xCBF29CE484222325ull;
+        for (const char* s : { path, "|", second }) {
+            for (; s && *s; s++) h = (h ^ static_cast<uint8_t>(*s)) * 0x100000001B3ull;
+        }
+        return h;
+    }
+
+    template <typename T>
+    AssetPool<T>& PoolOf() {
+        if constexpr (std::is_same_v<T, Texture2D>) return textures;
+        else if constexpr (std::is_same_v<T, Font>) return fonts;
+        else if constexpr (std::is_same_v<T, Shader>) return shaders;
+        else return models;
+    }
+
+    template <typename T>
+    const AssetPool<T>& PoolOf() const {
+        return const_cast<AssetCache*>(this)->PoolOf<T>();
+    }
+
+    void Pin(TextureHandle h) { if (h.Valid()) pinnedTextures.push_back(h); }
+    void Pin(FontHandle h)    { if (h.Valid()) pinnedFonts.push_back(h); }
+    void Pin(ShaderHandle h)  { if (h.Valid()) pinnedShaders.push_back(h); }
+    void Pin(ModelHandle h)   { if (h.Valid()) pinnedModels.push_back(h); }
+
+    AssetPool<Texture2D> textures;
+    AssetPool<Font>      fonts;
+    AssetPool<Shader>    shaders;
+    AssetPool<Model>     models;
+    std::vector<TextureHandle> pinnedTextures;
+    std::vector<FontHandle>    pinnedFonts;
+    std::vector<ShaderHandle>  pinnedShaders;
+    std::vector<ModelHandle>   pinnedModels;
+    AssetStats stats;
+};
+
+// --- SPRITE ATLAS ---
+// The images of the 2D frame (sprites, the default font's glyphs, the SDF
+// glyph tiers and a white block for raylib's shapes) packed into one texture
+// at load time, so the frame samples a single texture and rlgl's batch is
+// never split by a texture switch; only the text shader takes its own draw.
+// Packing uses stb_rect_pack, the copy raylib builds for font atlases.
+// Images sit on a grid of ALIGN texels with PADDING around them; every mip
+// level is resized from the source image and its edge texels are bled into
+// the padding again, so neither filtering nor mipmaps sample a neighbour.
+struct Sprite {
+    Texture2D texture = {};
+    Rectangle source = {};  // Texels of 'texture', as DrawTexturePro takes them
+
+    bool Valid() const {
+        return texture.id != 0;
+    }
+};
+
+class SpriteAtlas {
+public:
+    static constexpr int MIP_LEVELS = 5;
+    static constexpr int ALIGN = 1 << (MIP_LEVELS - 1);  // Image corners stay whole texels on every level
+    static constexpr int PADDING = ALIGN;                // One texel on the last level
+    static constexpr int MAX_SIZE = 4096;
+
+    static SpriteAtlas& Instance() {
+        static SpriteAtlas inst;
+        return inst;
+    }
+
+    // Queues an image for the next Build; missing files are skipped with a warning.
+    void Add(const char* path) {
+        Image image = LoadImage(path);
+        if (image.data == nullptr) {
+            TraceLog(LOG_WARNING, "ATLAS: could not load %s", path);
+            return;
+        }
+        Queue(path, image);
+    }
+
+    // Queues an image made in memory; the atlas takes ownership of it.
+    void Add(const char* name, Image image) {
+        if (image.data == nullptr) return;
+        Queue(name, image);
+    }
+
+    // Packs the queued images and uploads the atlas. The default font is
+    // always included. False leaves the atlas empty; Find then returns
+    // invalid sprites and callers use their own textures.
+    bool Build() {
+        if (!IsWindowReady()) return false;
+        ReleaseTexture();
+        std::erase_if(entries, [](const Entry& e) { return e.image.data == nullptr; });  // Built before
+
+        Font font = GetFontDefault();
+        if (font.texture.id != 0) Queue(FONT_NAME, LoadImageFromTexture(font.texture));
+        Queue(WHITE_NAME, GenImageColor(ALIGN, ALIGN, WHITE));
+
+        int size = Pack();
+        if (size == 0) {
+            TraceLog(LOG_WARNING, "ATLAS: %d images do not fit in %dx%d", static_cast<int>(entries.size()), MAX_SIZE, MAX_SIZE);
+            entries.clear();
+            return false;
+        }
+        texture = Upload(size);
+        for (Entry& e : entries) {
+            UnloadImage(e.image);
+            e.image = {};
+        }
+        if (texture.id == 0) {
+            entries.clear();
+            return false;
+        }
+
+        // Trilinear when minified; magnified glyphs stay as crisp as with point filtering
+        rlTextureParameters(texture.id, RL_TEXTURE_MIN_FILTER, RL_TEXTURE_FILTER_MIP_LINEAR);
+        rlTextureParameters(texture.id, RL_TEXTURE_MAG_FILTER, RL_TEXTURE_FILTER_NEAREST);
+        rlTextureParameters(texture.id, RL_TEXTURE_WRAP_S, RL_TEXTURE_WRAP_CLAMP);
+        rlTextureParameters(texture.id, RL_TEXTURE_WRAP_T, RL_TEXTURE_WRAP_CLAMP);
+
+        // raylib's shapes sample the middle of the white block
+        Rectangle white = Find(WHITE_NAME).source;
+        SetShapesTexture(texture, { white.x + white.width * 0.5f, white.y + white.height * 0.5f, 1.f, 1.f });
+
+        if (font.texture.id != 0) {
+            Rectangle fontSource = Find(FONT_NAME).source;
+            fontRecs.resize(static_cast<size_t>(font.glyphCount));
+            for (int i = 0; i < font.glyphCount; i++) {
+                fontRecs[i] = font.recs[i];
+                fontRecs[i].x += fontSource.x;
+                fontRecs[i].y += fontSource.y;
+            }
+            textFont = font;  // Glyph metrics are shared with raylib's default font
+            textFont.texture = texture;
+            textFont.recs = fontRecs.data();
+        }
+        TraceLog(LOG_INFO, "ATLAS: %d images in %dx%d, %d mip levels", static_cast<int>(entries.size()), size, size, MIP_LEVELS);
+        return true;
+    }
+
+    void Unload() {
+        ReleaseTexture();
+        for (Entry& e : entries) UnloadImage(e.image);
+        entries.clear();
+    }
+
+    // Invalid unless 'name' was built into the atlas.
+    Sprite Find(const char* name) const {
+        if (texture.id == 0) return {};
+        for (const Entry& e : entries) {
+            if (e.name == name) return { texture, e.source };
+        }
+        return {};
+    }
+
+    // raylib's default font with its glyphs in the atlas; the default font
+    // itself when there is no atlas.
+    Font TextFont() const {
+        return textFont.texture.id != 0 ? textFont : GetFontDefault();
+    }
+
+    const Texture2D& Texture() const {
+        return texture;
+    }
+
+private:
+    SpriteAtlas() = default;
+
+    static constexpr const char* FONT_NAME = "<default font>";
+    static constexpr const char* WHITE_NAME = "<white>";
+
+    struct Entry {
+        std::string name;
+        Image       image = {};
+        int         cellX = 0, cellY = 0;  // Grid cells of ALIGN texels
+        int         cellW = 0, cellH = 0;
+        Rectangle   source = {};
+    };
+
+    void ReleaseTexture() {
+        if (texture.id == 0) return;
+        SetShapesTexture({}, {});
+        UnloadTexture(texture);
+        texture = {};
+        textFont = {};
+        fontRecs.clear();
+    }
+
+    void Queue(const char* name, Image image) {
+        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        Entry& e = entries.emplace_back();
+        e.name = name;
+        e.image = image;
+        e.cellW = (image.width + 2 * PADDING + ALIGN - 1) / ALIGN;
+        e.cellH = (image.height + 2 * PADDING + ALIGN - 1) / ALIGN;
+    }
+
+    // Smallest power of two square the images fit in, 0 if none up to MAX_SIZE.
+    // Packs whole grid cells, so every placement is aligned.
+    int Pack() {
+        std::vector<stbrp_rect> rects(entries.size());
+        for (size_t i = 0; i < entries.size(); i++) {
+            rects[i] = {};
+            rects[i].id = static_cast<int>(i);
+            rects[i].w = entries[i].cellW;
+            rects[i].h = entries[i].cellH;
+        }
+
+        for (int size = 256; size <= MAX_SIZE; size *= 2) {
+            int cells = size / ALIGN;
+            std::vector<stbrp_node> nodes(static_cast<size_t>(cells));
+            stbrp_context context;
+            stbrp_init_target(&context, cells, cells, nodes.data(), cells);
+            if (!stbrp_pack_rects(&context, rects.data(), static_cast<int>(rects.size()))) continue;
+
+            for (const stbrp_rect& r : rects) {
+                Entry& e = entries[r.id];
+                e.cellX = r.x;
+                e.cellY = r.y;
+                e.source = { static_cast<float>(r.x * ALIGN + PADDING), static_cast<float>(r.y * ALIGN + PADDING),
+                             static_cast<float>(e.image.width), static_cast<float>(e.image.height) };
+            }
+            return size;
+        }
+        return 0;
+    }
+
+    // Lays every level out from the source images and uploads the chain.
+    Texture2D Upload(int size) {
+        size_t bytes = 0;
+        for (int level = 0; level < MIP_LEVELS; level++) {
+            bytes += static_cast<size_t>(size >> level) * static_cast<size_t>(size >> level) * sizeof(Color);
+        }
+        Color* pixels = static_cast<Color*>(RL_CALLOC(bytes, 1));
+
+        Color* levelPixels = pixels;
+        for (int level = 0; level < MIP_LEVELS; level++) {
+            int levelSize = size >> level;
+            for (const Entry& e : entries) Blit(e, level, levelPixels, levelSize);
+            levelPixels += static_cast<size_t>(levelSize) * levelSize;
+        }
+
+        Image atlas = { pixels, size, size, MIP_LEVELS, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+        Texture2D result = LoadTextureFromImage(atlas);
+        UnloadImage(atlas);
+        return result;
+    }
+
+    // Writes one image's level into its cell and repeats its edge texels
+    // across the rest of the cell.
+    static void Blit(const Entry& e, int level, Color* pixels, int stride) {
+        int scale = 1 << level;
+        int x0 = e.cellX * ALIGN / scale;
+        int y0 = e.cellY * ALIGN / scale;
+        int x1 = x0 + e.cellW * ALIGN / scale;
+        int y1 = y0 + e.cellH * ALIGN / scale;
+        int left = x0 + PADDING / scale;
+        int top = y0 + PADDING / scale;
+        int w = std::max(1, (e.image.width + scale - 1) / scale);
+        int h = std::max(1, (e.image.height + scale - 1) / scale);
+
+        Image image = level == 0 ? e.image : ImageCopy(e.image);
+        if (level > 0) ImageResize(&image, w, h);
+        const Color* src = static_cast<const Color*>(image.data);
+        for (int y = y0; y < y1; y++) {
+            const Color* row = src + static_cast<size_t>(std::clamp(y - top, 0, h - 1)) * w;
+            Color* dst = pixels + static_cast<size_t>(y) * stride;
+            for (int x = x0; x < x1; x++) dst[x] = row[std::clamp(x - left, 0, w - 1)];
+        }
+        if (level > 0) UnloadImage(image);
+    }
+
+    std::vector<Entry> entries;
+    Texture2D texture = {};
+    Font textFont = {};
+    std::vector<Rectangle> fontRecs;
+};
+
+// DrawText through the atlas copy of the default font, with DrawText's size
+// and spacing rules.
+inline void DrawAtlasText(const char* text, int x, int y, int fontSize, Color color) {
+    constexpr int defaultFontSize = 10;
+    fontSize = std::max(fontSize, defaultFontSize);
+    DrawTextEx(SpriteAtlas::Instance().TextFont(), text, { static_cast<float>(x), static_cast<float>(y) },
+        static_cast<float>(fontSize), static_cast<float>(fontSize / defaultFontSize), color);
+}
+
+// --- SDF SHAPES ---
+// Instanced renderer for the game's vector primitives. Every shape is one
+// rotated quad whose fragment shader evaluates a signed distance function, so
+// a frame of thousands of entities costs one draw call per Flush instead of
+// tessellated geometry pushed vertex by vertex through rlgl's batch.
+// Without GLSL 330 the same calls fall back to raylib's immediate drawing.
+class ShapeBatch {
+public:
+    bool Load() {
+        if (rlGetVersion() < RL_OPENGL_33) return false;
+        shader = rlLoadShaderCode(VERTEX_SHADER, FRAGMENT_SHADER);
+        if (shader == rlGetShaderIdDefault()) {
+            shader = 0;
+            return false;
+        }
+        mvpLoc = rlGetLocationUniform(shader, "mvp");
+
+        static constexpr float corners[] = { -1, -1,  1, -1,  1, 1,  -1, -1,  1, 1,  -1, 1 };
+        vao = rlLoadVertexArray();
+        rlEnableVertexArray(vao);
+        quadVbo = rlLoadVertexBuffer(corners, sizeof(corners), false);
+        SetAttribute("vertexPosition", 2, RL_FLOAT, false, 0, 0, 0);
+
+        instanceVbo = rlLoadVertexBuffer(nullptr, CAPACITY * sizeof(ShapeInstance), true);
+        SetAttribute("instanceTransform", 4, RL_FLOAT, false, sizeof(ShapeInstance), offsetof(ShapeInstance, x), 1);
+        SetAttribute("instanceShape", 4, RL_FLOAT, false, sizeof(ShapeInstance), offsetof(ShapeInstance, halfW), 1);
+        SetAttribute("instanceColor", 4, RL_UNSIGNED_BYTE, true, sizeof(ShapeInstance), offsetof(ShapeInstance, color), 1);
+        rlDisableVertexArray();
+
+        instances.reserve(CAPACITY);
+        return true;
+    }
+
+    void Unload() {
+        if (!Ready()) return;
+        rlUnloadVertexArray(vao);
+        rlUnloadVertexBuffer(quadVbo);
+        rlUnloadVertexBuffer(instanceVbo);
+        rlUnloadShaderProgram(shader);
+        shader = 0;
+    }
+
+    bool Ready() const {
+        return shader != 0;
+    }
+
+    // Regular polygon outline; the first vertex sits at 'rotation' degrees, as in DrawPolyLines.
+    void Polygon(Vector2 pos, int sides, float radius, float rotation, Color color) {
+        if (!Ready()) {
+            DrawPolyLines(pos, sides, radius, rotation, color);
+            return;
+        }
+        Push({ pos.x, pos.y, rotation * DEG2RAD, KIND_OUTLINE,
+               radius, radius, static_cast<float>(sides), radius * cosf(PI / sides), color });
+    }
+
+    // Star outline alternating 'points' outer vertices with inner ones at 'innerRadius'.
+    void Star(Vector2 pos, int points, float radius, float innerRadius, float rotation, Color color) {
+        if (!Ready()) {
+            float step = PI / points;
+            for (int i = 0; i < 2 * points; i++) {
+                float a0 = step * i + rotation * DEG2RAD, a1 = a0 + step;
+                float r0 = (i % 2) ? innerRadius : radius, r1 = (i % 2) ? radius : innerRadius;
+                DrawLineV({ pos.x + cosf(a0) * r0, pos.y + sinf(a0) * r0 },
+                          { pos.x + cosf(a1) * r1, pos.y + sinf(a1) * r1 }, color);
+            }
+            return;
+        }
+        Push({ pos.x, pos.y, rotation * DEG2RAD, KIND_OUTLINE,
+               radius, radius, static_cast<float>(points), innerRadius, color });
+    }
+
+    void Circle(Vector2 pos, float radius, Color color) {
+        if (!Ready()) {
+            DrawCircleV(pos, radius, color);
+            return;
+        }
+        Push({ pos.x, pos.y, 0.f, KIND_DISC, radius, radius, 0.f, 0.f, color });
+    }
+
+    void Ring(Vector2 pos, float radius, float width, Color color) {
+        if (!Ready()) {
+            DrawCircleLinesV(pos, radius, color);
+            return;
+        }
+        Push({ pos.x, pos.y, 0.f, KIND_RING, radius, radius, width, 0.f, color });
+    }
+
+    // Segment a-b with round caps of 'radius'.
+    void Capsule(Vector2 a, Vector2 b, float radius, Color color) {
+        if (!Ready()) {
+            DrawLineEx(a, b, radius * 2.f, color);
+            return;
+        }
+        Vector2 d = Vector2Subtract(b, a);
+        float halfLength = Vector2Length(d) * 0.5f;
+        Push({ (a.x + b.x) * 0.5f, (a.y + b.y) * 0.5f, atan2f(-d.x, d.y), KIND_CAPSULE,
+               radius, halfLength + radius, halfLength, radius, color });
+    }
+
+    // Draws everything queued so far. Call before raylib draws that must end up on top.
+    void Flush() {
+        if (instances.empty()) return;
+        PROFILE_ZONE("Shape flush");
+        rlDrawRenderBatchActive();  // raylib geometry queued earlier goes underneath
+
+        rlEnableShader(shader);
+        rlSetUniformMatrix(mvpLoc, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+        rlEnableVertexArray(vao);
+        rlUpdateVertexBuffer(instanceVbo, instances.data(), static_cast<int>(instances.size() * sizeof(ShapeInstance)), 0);
+        rlDisableBackfaceCulling();  // The y-down projection flips the quad's winding
+        rlDrawVertexArrayInstanced(0, 6, static_cast<int>(instances.size()));
+        rlEnableBackfaceCulling();
+        rlDisableVertexArray();
+        rlDisableShader();
+
+        frameDrawCalls++;
+        frameInstances += static_cast<int>(instances.size());
+        instances.clear();
+    }
+
+    // Keeps the finished frame's counters for display and starts counting anew.
+    void EndFrame() {
+        Flush();
+        drawCalls = frameDrawCalls;
+        instanceCount = frameInstances;
+        frameDrawCalls = 0;
+        frameInstances = 0;
+    }
+
+    int DrawCalls() const {
+        return drawCalls;
+    }
+
+    int Instances() const {
+        return instanceCount;
+    }
+
+private:
+    struct ShapeInstance {
+        float x, y, rotation, kind;          // rotation in radians
+        float halfW, halfH, param0, param1;  // quad half size (before padding), per-kind parameters
+        Color color;
+    };
+
+    static constexpr float KIND_OUTLINE = 0.f;  // param0: vertex count, param1: inner vertex radius
+    static constexpr float KIND_DISC = 1.f;
+    static constexpr float KIND_RING = 2.f;     // param0: line width
+    static constexpr float KIND_CAPSULE = 3.f;  // param0: half segment length, param1: radius
+    static constexpr size_t CAPACITY = 16'384;  // Instances per draw call
+
+    void Push(const ShapeInstance& instance) {
+        if (instances.size() == CAPACITY) Flush();
+        instances.push_back(instance);
+    }
+
+    // Points attribute 'name' at the bound vertex buffer; divisor 1 advances it once per instance.
+    void SetAttribute(const char* name, int components, int type, bool normalized, int stride, size_t offset, int divisor) {
+        int loc = rlGetLocationAttrib(shader, name);
+        if (loc < 0) return;
+        rlSetVertexAttribute(loc, components, type, normalized, stride, reinterpret_cast<const void*>(offset));
+        rlSetVertexAttributeDivisor(loc, divisor);
+        rlEnableVertexAttribute(loc);
+    }
+
+    static constexpr const char* VERTEX_SHADER = R"(#version 330
+in vec2 vertexPosition;
+in vec4 instanceTransform;
+in vec4 instanceShape;
+in vec4 instanceColor;
+uniform mat4 mvp;
+out vec2 local;
+flat out vec4 shape;
+flat out float kind;
+flat out vec4 color;
+void main() {
+    // Pad the quad so the 1px antialiased edge and outline width fit inside
+    local = vertexPosition * (instanceShape.xy + 2.0);
+    float c = cos(instanceTransform.z), s = sin(instanceTransform.z);
+    vec2 world = instanceTransform.xy + vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+    shape = instanceShape;
+    kind = instanceTransform.w;
+    color = instanceColor;
+    gl_Position = mvp * vec4(world, 0.0, 1.0);
+}
+)";
+
+    static constexpr const char* FRAGMENT_SHADER = R"(#version 330
+in vec2 local;
+flat in vec4 shape;
+flat in float kind;
+flat in vec4 color;
+out vec4 finalColor;
+const float PI = 3.14159265;
+const float LINE_WIDTH = 1.5;
+float Segment(vec2 p, vec2 a, vec2 b) {
+    vec2 pa = p - a, ba = b - a;
+    return length(pa - ba * clamp(dot(pa, ba) / dot(ba, ba), 0.0, 1.0));
+}
+void main() {
+    float d;
+    if (kind < 0.5) {
+        // Fold into the half sector between an outer vertex (angle 0) and the
+        // next inner vertex or edge midpoint, where the outline is one segment
+        float sector = PI / shape.z;
+        float a = mod(atan(local.y, local.x), 2.0 * sector);
+        a = sector - abs(a - sector);
+        vec2 q = length(local) * vec2(cos(a), sin(a));
+        d = Segment(q, vec2(shape.x, 0.0), shape.w * vec2(cos(sector), sin(sector))) - 0.5 * LINE_WIDTH;
+    }
+    else if (kind < 1.5) {
+        d = length(local) - shape.x;
+    }
+    else if (kind < 2.5) {
+        d = abs(length(local) - shape.x) - 0.5 * shape.z;
+    }
+    else {
+        d = length(vec2(local.x, local.y - clamp(local.y, -shape.z, shape.z))) - shape.w;
+    }
+    float coverage = clamp(0.5 - d, 0.0, 1.0);
+    if (coverage <= 0.0) discard;
+    finalColor = vec4(color.rgb, color.a * coverage);
+}
+)";
+
+    std::vector<ShapeInstance> instances;
+    unsigned int shader = 0;
+    int mvpLoc = -1;
+    unsigned int vao = 0;
+    unsigned int quadVbo = 0;
+    unsigned int instanceVbo = 0;
+
+    int frameDrawCalls = 0;
+    int frameInstances = 0;
+    int drawCalls = 0;
+    int instanceCount = 0;
+};
+
+// --- RENDERER ---
+class Renderer {
+public:
+    static Renderer& Instance() {
+        static Renderer inst;
+        return inst;
+    }
+
+    // targetFps 0 renders uncapped; vsync paces presentation to the display instead.
+    void Init(int w, int h, const char* title, int targetFps = 60, bool vsync = false) {
+        if (vsync) SetConfigFlags(FLAG_VSYNC_HINT);
+        InitWindow(w, h, title);
+        SetTargetFPS(targetFps);
+        screenW = w;
+        screenH = h;
+        if (!shapes.Load()) {
+            TraceLog(LOG_WARNING, "RENDERER: instanced shapes unavailable, using immediate mode");
+        }
+    }
+
+    void Close() {
+        shapes.Unload();
+        CloseWindow();
+    }
+
+    // No window and no GPU: only the logical screen size is known.
+    void InitHeadless(int w, int h) {
+        screenW = w;
+        screenH = h;
+    }
+
+    void Begin() {
+        BeginDrawing();
+        ClearBackground(BLACK);
+    }
+
+    void End() {
+        {
+            PROFILE_ZONE("Batch flush");
+            shapes.EndFrame();
+            rlDrawRenderBatchActive();
+        }
+        // Everything of this frame went through the batch by now
+        batchStats = rlGetRenderBatchStats();
+        rlResetRenderBatchStats();
+        PROFILE_ZONE("EndDrawing");  // Swap, event polling and frame pacing
+        EndDrawing();
+    }
+
+    void DrawPoly(const Vector2& pos, int sides, float radius, float rot, Color color = WHITE) {
+        shapes.Polygon(pos, sides, radius, rot, color);
+    }
+
+    ShapeBatch& Shapes() {
+        return shapes;
+    }
+
+    // rlgl batch counters of the last finished frame.
+    const rlRenderBatchStats& BatchStats() const {
+        return batchStats;
+    }
+
+    int Width() const {
+        return screenW;
+    }
+
+    int Height() const {
+        return screenH;
+    }
+
+private:
+    Renderer() = default;
+
+    int screenW{};
+    int screenH{};
+    ShapeBatch shapes;
+    rlRenderBatchStats batchStats{};
+};
+
+// --- TEXT ---
+// Signed distance field glyphs, baked once from a TTF through raylib's
+// FONT_SDF loader (stb_truetype) at two sizes in one sheet, which is packed
+// into the sprite atlas (or gets a texture of its own without one): small text reads
+// the small tier, large text the large one, and the shader keeps glyph edges
+// one pixel wide at any scale. Strings are shaped once into glyph runs cached
+// by content and tier, so a cached string costs a scale and offset per glyph.
+// Labels go further for text that rarely changes: they keep their formatted
+// string and run, and only format and look it up again when their key does.
+// Text is queued through the frame and drawn in one batched draw by Flush.
+// Without the font or GLSL 330 it falls back to DrawAtlasText.
+class TextRenderer {
+public:
+    static constexpr const char* FONT_PATH = "../resources/fonts/SourceCodePro-Bold.ttf";
+    static constexpr int TIER_SIZES[] = { 32, 80 };  // Baked pixel heights; text up to the first uses it
+    static constexpr int FIRST_CHAR = 32;            // Printable ASCII
+    static constexpr int CHAR_COUNT = 95;
+    static constexpr size_t CACHE_STRINGS = 512;     // Power of two
+    static constexpr size_t CACHE_GLYPHS = 16'384;
+    static constexpr size_t FRAME_GLYPHS = 4'096;    // Below rlgl's batch limit, so Flush is one draw
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;  // Strings shaped
+        int      resets = 0;  // Cache cleared because it was full
+        int      glyphs = 0;  // Glyphs in the last Flush
+    };
+
+    static TextRenderer& Instance() {
+        static TextRenderer inst;
+        return inst;
+    }
+
+    // A line that keeps its text between frames, such as a HUD counter. The
+    // key stands for the values shown; Format only runs snprintf when it changes.
+    class Label {
+    public:
+        template <typename... Args>
+        Label& Format(uint64_t newKey, const char* format, Args... args) {
+            if (!formatted || newKey != key) {
+                snprintf(text, sizeof(text), format, args...);
+                key = newKey;
+                formatted = true;
+                generation = 0;
+            }
+            return *this;
+        }
+
+        const char* Text() const {
+            return text;
+        }
+
+    private:
+        friend class TextRenderer;
+
+        char text[128] = {};
+        uint64_t key = 0;
+        bool formatted = false;
+        uint32_t first = 0;       // Glyphs in the cache arena
+        uint32_t count = 0;
+        uint64_t generation = 0;  // Cache generation they were shaped in, 0 = none
+        int tier = 0;
+    };
+
+    // Bakes the glyph tiers and queues their sheet for the sprite atlas; call
+    // before SpriteAtlas::Build and Load after it.
+    bool Bake() {
+        UnloadSheet();
+        if (!IsWindowReady() || rlGetVersion() < RL_OPENGL_33) return false;
+        int fileSize = 0;
+        unsigned char* fileData = LoadFileData(FONT_PATH, &fileSize);
+        if (fileData == nullptr) return false;
+
+        constexpr int tierCount = static_cast<int>(std::size(TIER_SIZES));
+        GlyphInfo* tierGlyphs[tierCount] = {};
+        std::vector<GlyphInfo> all;
+        bool loaded = true;
+        for (int t = 0; t < tierCount; t++) {
+            tierGlyphs[t] = LoadFontData(fileData, fileSize, TIER_SIZES[t], nullptr, CHAR_COUNT, FONT_SDF);
+            if (tierGlyphs[t] == nullptr) loaded = false;
+            else all.insert(all.end(), tierGlyphs[t], tierGlyphs[t] + CHAR_COUNT);
+        }
+        UnloadFileData(fileData);
+
+        Rectangle* recs = nullptr;
+        if (loaded) sheet = GenImageFontAtlas(all.data(), &recs, static_cast<int>(all.size()), TIER_SIZES[tierCount - 1], ATLAS_PADDING, 1);
+        if (sheet.data != nullptr) {
+            sheetRecs.assign(recs, recs + all.size());
+            for (int t = 0; t < tierCount; t++) {
+                for (int i = 0; i < CHAR_COUNT; i++) {
+                    const GlyphInfo& info = tierGlyphs[t][i];
+                    const Rectangle& rec = sheetRecs[t * CHAR_COUNT + i];
+                    Glyph& g = glyphs[t][i];
+                    g.x0 = static_cast<float>(info.offsetX);
+                    g.y0 = static_cast<float>(info.offsetY);
+                    g.x1 = g.x0 + rec.width;
+                    g.y1 = g.y0 + rec.height;
+                    g.advance = static_cast<float>(info.advanceX);
+                    g.visible = info.value != ' ';
+                }
+            }
+            SpriteAtlas::Instance().Add(SHEET_NAME, ImageCopy(sheet));
+        }
+        for (GlyphInfo* tier : tierGlyphs) {
+            if (tier != nullptr) UnloadFontData(tier, CHAR_COUNT);
+        }
+        MemFree(recs);
+        return sheet.data != nullptr;
+    }
+
+    // Points the glyphs at the sheet in the atlas, or uploads the sheet if the
+    // atlas was not built, and loads the shader.
+    bool Load() {
+        if (sheet.data == nullptr) return false;
+        Sprite source = SpriteAtlas::Instance().Find(SHEET_NAME);
+        if (!source.Valid()) {
+            ownTexture = LoadTextureFromImage(sheet);
+            SetTextureFilter(ownTexture, TEXTURE_FILTER_BILINEAR);
+            source = { ownTexture, { 0.f, 0.f, static_cast<float>(sheet.width), static_cast<float>(sheet.height) } };
+        }
+        texture = source.texture;
+        if (texture.id != 0) {
+            float w = static_cast<float>(texture.width), h = static_cast<float>(texture.height);
+            for (size_t t = 0; t < std::size(TIER_SIZES); t++) {
+                for (int i = 0; i < CHAR_COUNT; i++) {
+                    const Rectangle& rec = sheetRecs[t * CHAR_COUNT + i];
+                    Glyph& g = glyphs[t][i];
+                    g.u0 = (source.source.x + rec.x) / w;
+                    g.v0 = (source.source.y + rec.y) / h;
+                    g.u1 = (source.source.x + rec.x + rec.width) / w;
+                    g.v1 = (source.source.y + rec.y + rec.height) / h;
+                }
+            }
+        }
+        UnloadSheet();
+        if (texture.id == 0) return false;
+
+        shader = LoadShaderFromMemory(nullptr, FRAGMENT_SHADER);
+        if (!IsShaderReady(shader) || shader.id == rlGetShaderIdDefault()) {
+            Unload();
+            return false;
+        }
+        runs.assign(CACHE_STRINGS, {});
+        arena.reserve(CACHE_GLYPHS);
+        scratch.reserve(FRAME_GLYPHS);
+        queue.reserve(FRAME_GLYPHS);
+        return true;
+    }
+
+    void Unload() {
+        if (shader.id != 0 && shader.id != rlGetShaderIdDefault()) UnloadShader(shader);
+        if (ownTexture.id != 0) UnloadTexture(ownTexture);
+        UnloadSheet();
+        shader = {};
+        texture = {};
+        ownTexture = {};
+        ClearCache();
+        queue.clear();
+    }
+
+    // With caching off every string is shaped again on every call, for comparison.
+    void SetCaching(bool enabled) {
+        caching = enabled;
+    }
+
+    // Same placement as DrawText: (x, y) is the top left of the first line.
+    void Draw(const char* text, int x, int y, int fontSize, Color color) {
+        if (texture.id == 0) {
+            DrawAtlasText(text, x, y, fontSize, color);
+            return;
+        }
+        Run run = Shape(text, fontSize);
+        Enqueue(caching ? arena.data() + run.first : scratch.data(), run.count, x, y, fontSize, color);
+    }
+
+    // Reuses the label's run while the cache still holds it.
+    void Draw(Label& label, int x, int y, int fontSize, Color color) {
+        if (texture.id == 0 || !caching) {
+            Draw(label.text, x, y, fontSize, color);
+            return;
+        }
+        int tier = TierOf(fontSize);
+        if (label.generation != generation || label.tier != tier) {
+            Run run = Shape(label.text, fontSize);
+            label.first = run.first;
+            label.count = run.count;
+            label.generation = generation;
+            label.tier = tier;
+        }
+        else {
+            stats.hits++;
+        }
+        Enqueue(arena.data() + label.first, label.count, x, y, fontSize, color);
+    }
+
+    // Width of the widest line in pixels, as MeasureText.
+    int Measure(const char* text, int fontSize) {
+        if (texture.id == 0) {
+            constexpr int defaultFontSize = 10;
+            fontSize = std::max(fontSize, defaultFontSize);
+            return static_cast<int>(MeasureTextEx(SpriteAtlas::Instance().TextFont(), text, static_cast<float>(fontSize),
+                static_cast<float>(fontSize / defaultFontSize)).x);
+        }
+        float scale = static_cast<float>(fontSize) / TIER_SIZES[TierOf(fontSize)];
+        return static_cast<int>(Shape(text, fontSize).width * scale);
+    }
+
+    // Draws everything queued since the last Flush.
+    void Flush() {
+        stats.glyphs = static_cast<int>(queue.size());
+        if (queue.empty()) return;
+        BeginShaderMode(shader);
+        rlSetTexture(texture.id);
+        rlBegin(RL_QUADS);
+        rlNormal3f(0.f, 0.f, 1.f);
+        for (const QueuedGlyph& q : queue) {
+            rlColor4ub(q.color.r, q.color.g, q.color.b, q.color.a);
+            rlTexCoord2f(q.u0, q.v0);
+            rlVertex2f(q.x0, q.y0);
+            rlTexCoord2f(q.u0, q.v1);
+            rlVertex2f(q.x0, q.y1);
+            rlTexCoord2f(q.u1, q.v1);
+            rlVertex2f(q.x1, q.y1);
+            rlTexCoord2f(q.u1, q.v0);
+            rlVertex2f(q.x1, q.y0);
+        }
+        rlEnd();
+        rlSetTexture(0);
+        EndShaderMode();
+        queue.clear();
+    }
+
+    const Stats& GetStats() const {
+        return stats;
+    }
+
+private:
+    TextRenderer() = default;
+
+    static constexpr const char* SHEET_NAME = "<sdf glyphs>";
+    static constexpr int ATLAS_PADDING = 2;
+    static constexpr float LINE_SPACING = 1.2f;  // In font heights
+
+    // One glyph of a tier, positioned in the tier's pixels from the pen.
+    struct Glyph {
+        float x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+        float u0 = 0, v0 = 0, u1 = 0, v1 = 0;
+        float advance = 0;
+        bool  visible = false;
+    };
+
+    struct Run {
+        uint64_t key = 0;  // 0: empty slot
+        uint32_t first = 0;
+        uint32_t count = 0;
+        float    width = 0;
+    };
+
+    struct QueuedGlyph {
+        float x0, y0, x1, y1;
+        float u0, v0, u1, v1;
+        Color color;
+    };
+
+    static int TierOf(int fontSize) {
+        return fontSize <= TIER_SIZES[0] ? 0 : 1;
+    }
+
+    void Enqueue(const Glyph* shaped, uint32_t count, int x, int y, int fontSize, Color color) {
+        float scale = static_cast<float>(fontSize) / TIER_SIZES[TierOf(fontSize)];
+        float ox = static_cast<float>(x), oy = static_cast<float>(y);
+        for (uint32_t i = 0; i < count && queue.size() < FRAME_GLYPHS; i++) {
+            const Glyph& g = shaped[i];
+            queue.push_back({ ox + g.x0 * scale, oy + g.y0 * scale, ox + g.x1 * scale, oy + g.y1 * scale,
+                              g.u0, g.v0, g.u1, g.v1, color });
+        }
+    }
+
+    // Cached run of 'text', shaped now on a miss. With caching off the glyphs
+    // land in 'scratch' instead.
+    Run Shape(const char* text, int fontSize) {
+        int tier = TierOf(fontSize);
+        if (!caching) {
+            scratch.clear();
+            return Layout(text, tier, scratch, FRAME_GLYPHS);
+        }
+
+        // 64-bit FNV-1a of the tier and the text
+        uint64_t key = 0xCBF29CE484222325ull;
+        key = (key ^ static_cast<uint8_t>(tier)) * 0x100000001B3ull;
+        size_t length = 0;
+        for (; text[length] != '\0'; length++) key = (key ^ static_cast<uint8_t>(text[length])) * 0x100000001B3ull;
+        key |= 1;  // Never 0
+
+        size_t mask = CACHE_STRINGS - 1;
+        size_t slot = key & mask;
+        for (; runs[slot].key != 0; slot = (slot + 1) & mask) {
+            if (runs[slot].key == key) {
+                stats.hits++;
+                return runs[slot];
+            }
+        }
+
+        // Full table (kept under 3/4 for short probes) or arena: start over
+        stats.misses++;
+        if (runCount >= CACHE_STRINGS * 3 / 4 || arena.size() + length > CACHE_GLYPHS) {
+            ClearCache();
+            stats.resets++;
+            for (slot = key & mask; runs[slot].key != 0; slot = (slot + 1) & mask) {}
+        }
+        Run run = Layout(text, tier, arena, CACHE_GLYPHS);
+        run.key = key;
+        runs[slot] = run;
+        runCount++;
+        return run;
+    }
+
+    // Appends the glyphs of 'text' to 'out' (up to 'capacity') and returns
+    // their range and the widest line.
+    Run Layout(const char* text, int tier, std::vector<Glyph>& out, size_t capacity) const {
+        Run run;
+        run.first = static_cast<uint32_t>(out.size());
+        float penX = 0.f, penY = 0.f;
+        for (int i = 0; text[i] != '\0';) {
+            int bytes = 0;
+            int codepoint = GetCodepointNext(&text[i], &bytes);
+            i += bytes;
+            if (codepoint == '\n') {
+                penX = 0.f;
+                penY += TIER_SIZES[tier] * LINE_SPACING;
+                continue;
+            }
+            int index = codepoint - FIRST_CHAR;
+            if (index < 0 || index >= CHAR_COUNT) index = '?' - FIRST_CHAR;
+            const Glyph& g = glyphs[tier][index];
+            if (g.visible && out.size() < capacity) {
+                Glyph placed = g;
+                placed.x0 += penX;
+                placed.x1 += penX;
+                placed.y0 += penY;
+                placed.y1 += penY;
+                out.push_back(placed);
+            }
+            penX += g.advance;
+            run.width = std::max(run.width, penX);
+        }
+        run.count = static_cast<uint32_t>(out.size()) - run.first;
+        return run;
+    }
+
+    void UnloadSheet() {
+        UnloadImage(sheet);
+        sheet = {};
+        sheetRecs.clear();
+    }
+
+    void ClearCache() {
+        std::fill(runs.begin(), runs.end(), Run{});
+        runCount = 0;
+        arena.clear();
+        generation++;  // Drops the runs held by labels
+    }
+
+    // Distance is 0.5 on the outline; fwidth turns it into one pixel of coverage.
+    // The atlas magnifies with point sampling, which would make large text
+    // blocky, so magnified glyphs blend the four nearest texels themselves.
+    static constexpr const char* FRAGMENT_SHADER = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+out vec4 finalColor;
+void main() {
+    vec2 texel = fragTexCoord * vec2(textureSize(texture0, 0));
+    float sdf = texture(texture0, fragTexCoord).a;
+    vec2 footprint = fwidth(texel);
+    if (max(footprint.x, footprint.y) < 1.0) {
+        vec2 p = texel - 0.5;
+        ivec2 i = ivec2(floor(p));
+        vec2 f = p - floor(p);
+        float top = mix(texelFetch(texture0, i, 0).a, texelFetch(texture0, i + ivec2(1, 0), 0).a, f.x);
+        float bottom = mix(texelFetch(texture0, i + ivec2(0, 1), 0).a, texelFetch(texture0, i + ivec2(1, 1), 0).a, f.x);
+        sdf = mix(top, bottom, f.y);
+    }
+    float edge = sdf - 0.5;
+    float coverage = clamp(edge / max(fwidth(edge), 0.0001) + 0.5, 0.0, 1.0);
+    finalColor = vec4(fragColor.rgb, fragColor.a * coverage) * colDiffuse;
+}
+)";
+
+    Glyph glyphs[std::size(TIER_SIZES)][CHAR_COUNT];
+    Image sheet = {};                  // Between Bake and Load
+    std::vector<Rectangle> sheetRecs;  // Glyph texels in 'sheet', tier by tier
+    Texture2D texture = {};            // The atlas or 'ownTexture'
+    Texture2D ownTexture = {};
+    Shader shader = {};
+    std::vector<Run> runs;
+    size_t runCount = 0;
+    uint64_t generation = 1;
+    std::vector<Glyph> arena;    // Glyphs of the cached runs
+    std::vector<Glyph> scratch;  // Uncached run being drawn
+    std::vector<QueuedGlyph> queue;
+    bool caching = true;
+    Stats stats;
+};
+
+// --- SOUND EFFECTS ---
+// Fixed ring between one producing and one consuming thread. Push and Pop
+// never block or allocate; Push fails when the ring is full.
+template <typename T, size_t CAPACITY>
+class SpscQueue {
+    static_assert(std::has_single_bit(CAPACITY), "SpscQueue capacity must be a power of two");
+
+public:
+    bool Push(const T& item) {
+        size_t tail = writeIndex.load(std::memory_order_relaxed);
+        if (tail - readIndex.load(std::memory_order_acquire) == CAPACITY) return false;
+        items[tail & (CAPACITY - 1)] = item;
+        writeIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T& item) {
+        size_t head = readIndex.load(std::memory_order_relaxed);
+        if (head == writeIndex.load(std::memory_order_acquire)) return false;
+        item = items[head & (CAPACITY - 1)];
+        readIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // Separate cache lines, so the two threads do not invalidate each other's index
+    alignas(64) std::atomic<size_t> writeIndex{ 0 };
+    alignas(64) std::atomic<size_t> readIndex{ 0 };
+    T items[CAPACITY];
+};
+
+enum class Sfx : uint8_t { LASER, BULLET, EXPLOSION, HIT, POWERUP, LEVEL_UP, COUNT };
+
+// Game sounds mixed by our own voice pool inside one raudio stream callback,
+// so a burst of shots never runs into raudio's pool of 16 sound channels and
+// the game thread never takes raudio's mixer lock. Every clip is synthesized
+// (or decoded from ../resources/sfx/<name>.wav) into one PCM bank at load.
+// Play queues a command through a lock-free ring; the callback starts the
+// queued voices, stealing the oldest voice of the lowest priority when all
+// are busy, and mixes. The callback never allocates or locks.
+// Play is called by one thread at a time: the game thread or the tick job it
+// is waiting on.
+class SoundEffects {
+public:
+    static constexpr int SAMPLE_RATE = 48'000;
+    static constexpr int MAX_VOICES = 32;
+    static constexpr size_t QUEUE_CAPACITY = 256;
+    static constexpr const char* OVERRIDE_DIR = "../resources/sfx";
+
+    struct Stats {
+        uint64_t callbacks = 0;
+        uint64_t frames = 0;
+        uint64_t mixNs = 0;     // Total time spent in the callback
+        uint64_t maxMixNs = 0;
+        uint64_t started = 0;
+        uint64_t stolen = 0;    // Voices cut off for a new sound
+        uint64_t dropped = 0;   // Sounds not played: queue full or every voice more important
+        int      voices = 0;    // Playing in the last callback
+        int      peakVoices = 0;
+    };
+
+    static SoundEffects& Instance() {
+        static SoundEffects inst;
+        return inst;
+    }
+
+    // Needs an initialized audio device.
+    bool Load() {
+        if (!IsAudioDeviceReady()) return false;
+        bank.clear();
+        for (size_t i = 0; i < std::size(CLIPS); i++) {
+            Clip& clip = clips[i];
+            clip.offset = static_cast<uint32_t>(bank.size());
+            if (!Decode(CLIPS[i].name)) Synthesize(static_cast<Sfx>(i));
+            clip.length = static_cast<uint32_t>(bank.size()) - clip.offset;
+        }
+        for (Voice& voice : voices) voice = {};
+
+        stream = LoadAudioStream(SAMPLE_RATE, 32, 2);
+        if (!IsAudioStreamReady(stream)) {
+            stream = {};
+            return false;
+        }
+        SetAudioStreamCallback(stream, MixCallback);
+        PlayAudioStream(stream);
+        running = true;
+        return true;
+    }
+
+    void Unload() {
+        if (!running) return;
+        running = false;
+        UnloadAudioStream(stream);  // Waits for a callback in progress
+        stream = {};
+        Command command;
+        while (commands.Pop(command)) {}
+        bank.clear();
+    }
+
+    // Sounds are attenuated and panned relative to this point, the ship.
+    void SetListener(Vector2 position) {
+        listener = position;
+    }
+
+    void Play(Sfx sfx, Vector2 position, float gain = 1.f) {
+        if (!running) return;
+        float dx = position.x - listener.x;
+        float dy = position.y - listener.y;
+        float attenuation = REFERENCE_DISTANCE / (REFERENCE_DISTANCE + sqrtf(dx * dx + dy * dy));
+        float pan = std::clamp(dx / PAN_DISTANCE, -1.f, 1.f);  // -1: left
+        float angle = (pan + 1.f) * (PI / 4.f);                // Equal power
+        Command command = { sfx, gain * attenuation * cosf(angle), gain * attenuation * sinf(angle) };
+        if (!commands.Push(command)) queueFull++;
+    }
+
+    bool Running() const {
+        return running;
+    }
+
+    Stats GetStats() const {
+        Stats s;
+        s.callbacks = counters.callbacks.load(std::memory_order_relaxed);
+        s.frames = counters.frames.load(std::memory_order_relaxed);
+        s.mixNs = counters.mixNs.load(std::memory_order_relaxed);
+        s.maxMixNs = counters.maxMixNs.load(std::memory_order_relaxed);
+        s.started = counters.started.load(std::memory_order_relaxed);
+        s.stolen = counters.stolen.load(std::memory_order_relaxed);
+        s.dropped = counters.dropped.load(std::memory_order_relaxed) + queueFull;
+        s.voices = counters.voices.load(std::memory_order_relaxed);
+        s.peakVoices = counters.peakVoices.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    SoundEffects() = default;
+
+    static constexpr float REFERENCE_DISTANCE = 400.f;  // Half volume this far from the listener
+    static constexpr float PAN_DISTANCE = 640.f;        // Fully to one side this far from the listener
+    static constexpr float MASTER_GAIN = 0.5f;
+    static constexpr int   FADE_FRAMES = 64;            // Edges of synthesized clips, against clicks
+
+    struct ClipInfo {
+        const char* name;
+        float   seconds;    // Synthesized length
+        uint8_t priority;   // Higher steals lower
+        uint8_t maxVoices;  // More instances restart the oldest one
+    };
+
+    static constexpr ClipInfo CLIPS[] = {
+        { "laser",     0.18f, 1, 6 },
+        { "bullet",    0.09f, 1, 6 },
+        { "explosion", 0.70f, 2, 10 },
+        { "hit",       0.35f, 3, 2 },
+        { "powerup",   0.30f, 3, 2 },
+        { "level_up",  0.70f, 4, 1 },
+    };
+    static_assert(std::size(CLIPS) == static_cast<size_t>(Sfx::COUNT));
+
+    struct Clip {
+        uint32_t offset = 0;  // Into 'bank'
+        uint32_t length = 0;
+    };
+
+    struct Voice {
+        int      clip = -1;  // -1: free
+        uint32_t cursor = 0;
+        float    left = 0.f, right = 0.f;
+    };
+
+    struct Command {
+        Sfx   sfx;
+        float left, right;
+    };
+
+    // Written by the audio thread only
+    struct Counters {
+        std::atomic<uint64_t> callbacks{ 0 };
+        std::atomic<uint64_t> frames{ 0 };
+        std::atomic<uint64_t> mixNs{ 0 };
+        std::atomic<uint64_t> maxMixNs{ 0 };
+        std::atomic<uint64_t> started{ 0 };
+        std::atomic<uint64_t> stolen{ 0 };
+        std::atomic<uint64_t> dropped{ 0 };
+        std::atomic<int>      voices{ 0 };
+        std::atomic<int>      peakVoices{ 0 };
+    };
+
+    bool Decode(const char* name) {
+        const char* path = TextFormat("%s/%s.wav", OVERRIDE_DIR, name);
+        if (!FileExists(path)) return false;
+        Wave wave = LoadWave(path);
+        if (!IsWaveReady(wave)) return false;
+        WaveFormat(&wave, SAMPLE_RATE, 32, 1);
+        const float* samples = static_cast<const float*>(wave.data);
+        bank.insert(bank.end(), samples, samples + wave.frameCount);
+        UnloadWave(wave);
+        return true;
+    }
+
+    // Appends the built-in version of 'sfx' to the bank. Uses its own noise,
+    // so the game's random streams are untouched.
+    void Synthesize(Sfx sfx) {
+        const ClipInfo& info = CLIPS[static_cast<size_t>(sfx)];
+        int count = static_cast<int>(info.seconds * SAMPLE_RATE);
+        size_t first = bank.size();
+        bank.resize(first + count);
+        float* out = bank.data() + first;
+
+        uint32_t noiseState = 0x9E3779B9u;
+        auto noise = [&noiseState] {
+            noiseState ^= noiseState << 13;
+            noiseState ^= noiseState >> 17;
+            noiseState ^= noiseState << 5;
+            return static_cast<float>(noiseState) / 2147483648.f - 1.f;
+        };
+        float phase = 0.f;
+        float lowPass = 0.f;
+        for (int i = 0; i < count; i++) {
+            float t = static_cast<float>(i) / SAMPLE_RATE;
+            float s = 0.f;
+            switch (sfx) {
+            case Sfx::LASER:
+                // Falling square-ish sweep
+                phase += (250.f + 1500.f * expf(-t * 14.f)) / SAMPLE_RATE;
+                s = (sinf(2.f * PI * phase) + 0.3f * sinf(6.f * PI * phase)) * expf(-t * 18.f) * 0.5f;
+                break;
+            case Sfx::BULLET:
+                // Noise click over a low thump
+                s = noise() * expf(-t * 60.f) * 0.6f + sinf(2.f * PI * 160.f * t) * expf(-t * 30.f) * 0.5f;
+                break;
+            case Sfx::EXPLOSION:
+                // Noise through a low-pass that closes as it decays
+                lowPass += (noise() - lowPass) * (0.02f + 0.2f * expf(-t * 6.f));
+                s = lowPass * expf(-t * 5.f) * 2.f;
+                break;
+            case Sfx::HIT:
+                phase += 110.f * expf(-t * 3.f) / SAMPLE_RATE;
+                s = (sinf(2.f * PI * phase) * 0.7f + noise() * expf(-t * 20.f) * 0.3f) * expf(-t * 8.f);
+                break;
+            case Sfx::POWERUP:
+            case Sfx::LEVEL_UP: {
+                // Rising arpeggio
+                static constexpr float notes[] = { 523.25f, 659.25f, 783.99f, 1046.5f };
+                float step = sfx == Sfx::POWERUP ? 0.1f : 0.15f;
+                int last = sfx == Sfx::POWERUP ? 2 : 3;
+                int note = std::min(static_cast<int>(t / step), last);
+                phase += notes[note] / SAMPLE_RATE;
+                float since = t - note * step;
+                s = (sinf(2.f * PI * phase) + 0.2f * sinf(4.f * PI * phase)) * expf(-since * 10.f) * 0.4f;
+                break;
+            }
+            default:
+                break;
+            }
+            out[i] = s;
+        }
+        for (int i = 0; i < std::min(FADE_FRAMES, count); i++) {
+            float ramp = static_cast<float>(i) / FADE_FRAMES;
+            out[i] *= ramp;
+            out[count - 1 - i] *= ramp;
+        }
+    }
+
+    // Audio thread from here on.
+    static void MixCallback(void* buffer, unsigned int frames) {
+        Instance().Mix(static_cast<float*>(buffer), frames);
+    }
+
+    void Mix(float* out, unsigned int frames) {
+        auto start = std::chrono::steady_clock::now();
+        Command command;
+        while (commands.Pop(command)) Start(command);
+
+        std::fill(out, out + frames * 2, 0.f);
+        int playing = 0;
+        for (Voice& voice : voices) {
+            if (voice.clip < 0) continue;
+            playing++;
+            const Clip& clip = clips[voice.clip];
+            uint32_t count = std::min<uint32_t>(frames, clip.length - voice.cursor);
+            const float* in = bank.data() + clip.offset + voice.cursor;
+            for (uint32_t i = 0; i < count; i++) {
+                out[i * 2] += in[i] * voice.left;
+                out[i * 2 + 1] += in[i] * voice.right;
+            }
+            voice.cursor += count;
+            if (voice.cursor == clip.length) voice.clip = -1;
+        }
+        for (size_t i = 0; i < frames * 2; i++) out[i] = std::clamp(out[i] * MASTER_GAIN, -1.f, 1.f);
+
+        uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        counters.callbacks.fetch_add(1, std::memory_order_relaxed);
+        counters.frames.fetch_add(frames, std::memory_order_relaxed);
+        counters.mixNs.fetch_add(ns, std::memory_order_relaxed);
+        if (ns > counters.maxMixNs.load(std::memory_order_relaxed)) counters.maxMixNs.store(ns, std::memory_order_relaxed);
+        counters.voices.store(playing, std::memory_order_relaxed);
+        if (playing > counters.peakVoices.load(std::memory_order_relaxed)) counters.peakVoices.store(playing, std::memory_order_relaxed);
+    }
+
+    // Picks a voice for 'command': the oldest instance of the same clip once
+    // it has maxVoices, else a free voice, else the oldest voice of the lowest
+    // priority not above the new sound's.
+    void Start(const Command& command) {
+        int index = static_cast<int>(command.sfx);
+        const ClipInfo& info = CLIPS[index];
+        Voice* free = nullptr;
+        Voice* oldestSame = nullptr;
+        Voice* victim = nullptr;
+        int same = 0;
+        for (Voice& voice : voices) {
+            if (voice.clip < 0) {
+                if (!free) free = &voice;
+                continue;
+            }
+            if (voice.clip == index) {
+                same++;
+                if (!oldestSame || voice.cursor > oldestSame->cursor) oldestSame = &voice;
+            }
+            uint8_t priority = CLIPS[voice.clip].priority;
+            if (priority > info.priority) continue;
+            if (!victim || priority < CLIPS[victim->clip].priority ||
+                (priority == CLIPS[victim->clip].priority && voice.cursor > victim->cursor)) {
+                victim = &voice;
+            }
+        }
+
+        Voice* chosen = same >= info.maxVoices ? oldestSame : free ? free : victim;
+        if (!chosen) {
+            counters.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (chosen->clip >= 0) counters.stolen.fetch_add(1, std::memory_order_relaxed);
+        *chosen = { index, 0, command.left, command.right };
+        counters.started.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::vector<float> bank;  // Mono clips at SAMPLE_RATE, fixed while the stream runs
+    Clip clips[std::size(CLIPS)];
+    Voice voices[MAX_VOICES];  // Audio thread only
+    SpscQueue<Command, QUEUE_CAPACITY> commands;
+    Counters counters;
+    AudioStream stream = {};
+    Vector2 listener = {};
+    uint64_t queueFull = 0;  // Producer side
+    bool running = false;
+};
+
+// --- MUSIC ---
+// Level music decoded off the main thread. A decoder thread runs raudio's
+// decoders (DecodeMusicStream), resamples to SAMPLE_RATE stereo and keeps a
+// lock-free ring of frames the prefetch depth ahead of playback; the callback
+// of one raudio stream only copies out of the ring, so a long frame or a
+// decode spike no longer starves the stream. Tracks loop without a gap, as the
+// decoders wrap around by themselves. A level change crossfades to the level's
+// track; the fade is mixed by the decoder, so it is heard up to one prefetch
+// depth later. The main thread only stores the wanted track.
+// Tracks are ../resources/music/level1.<ext>, level2.<ext>, ... in any format
+// raudio streams; without them there is no music.
+class MusicStreamer {
+public:
+    static constexpr int SAMPLE_RATE = SoundEffects::SAMPLE_RATE;
+    static constexpr const char* MUSIC_DIR = "../resources/music";
+    static constexpr const char* EXTENSIONS[] = { "ogg", "mp3", "qoa", "xm", "mod", "wav", "flac" };
+    static constexpr int MAX_TRACKS = 8;
+    static constexpr int DEFAULT_PREFETCH_MS = 250;
+    static constexpr float CROSSFADE_SECONDS = 2.f;
+
+    struct Stats {
+        uint64_t underruns = 0;       // Callbacks the ring could not fill after playback started
+        uint64_t underrunFrames = 0;  // Silence played in their place
+        uint64_t chunks = 0;          // Decoded by the decoder thread
+        uint64_t decodeNs = 0;
+        uint64_t maxDecodeNs = 0;
+        int      bufferedFrames = 0;
+        int      minBufferedFrames = 0;  // Lowest ring level after a callback, since playback started
+        int      prefetchFrames = 0;
+        int      tracks = 0;
+        int      track = -1;             // Being decoded
+    };
+
+    static MusicStreamer& Instance() {
+        static MusicStreamer inst;
+        return inst;
+    }
+
+    // Frames decoded ahead of playback; more survives longer stalls of the
+    // decoder thread, less makes track changes heard sooner. Set before Load.
+    void SetPrefetch(int milliseconds) {
+        prefetchFrames = std::max(milliseconds * SAMPLE_RATE / 1000, 2 * DECODE_FRAMES);
+    }
+
+    // Needs an initialized audio device; false without tracks.
+    bool Load() {
+        if (!IsAudioDeviceReady()) return false;
+        tracks.reserve(MAX_TRACKS);
+        for (int level = 1; level <= MAX_TRACKS; level++) {
+            const char* path = nullptr;
+            for (const char* extension : EXTENSIONS) {
+                const char* candidate = TextFormat("%s/level%d.%s", MUSIC_DIR, level, extension);
+                if (FileExists(candidate)) {
+                    path = candidate;
+                    break;
+                }
+            }
+            if (!path) break;
+            Music music = LoadMusicStream(path);
+            if (!IsMusicReady(music)) break;
+
+            Track& track = tracks.emplace_back();
+            track.music = music;
+            track.step = static_cast<float>(music.stream.sampleRate) / SAMPLE_RATE;
+            track.raw.resize(static_cast<size_t>(SOURCE_FRAMES) * music.stream.channels * (music.stream.sampleSize == 32 ? 4 : 2));
+            track.source.resize(static_cast<size_t>(SOURCE_FRAMES) * 2);
+        }
+        if (tracks.empty()) return false;
+
+        ring.Allocate(prefetchFrames);
+        primed = false;
+        current = std::clamp(requested.load(std::memory_order_relaxed), 0, static_cast<int>(tracks.size()) - 1);
+        fadeFrom = -1;
+        counters.track.store(current, std::memory_order_relaxed);
+
+        stream = LoadAudioStream(SAMPLE_RATE, 32, 2);
+        if (!IsAudioStreamReady(stream)) {
+            stream = {};
+            UnloadTracks();
+            return false;
+        }
+        SetAudioStreamCallback(stream, MixCallback);
+        running.store(true, std::memory_order_release);
+        decoder = std::thread([this] { DecodeLoop(); });
+        PlayAudioStream(stream);
+        return true;
+    }
+
+    void Unload() {
+        if (!running.load(std::memory_order_acquire)) return;
+        running.store(false, std::memory_order_release);
+        decoder.join();
+        UnloadAudioStream(stream);  // Waits for a callback in progress
+        stream = {};
+        UnloadTracks();
+    }
+
+    // Track of the level; picked up by the decoder, crossfading from the
+    // current one. Tracks repeat when there are more levels than tracks.
+    void SetTrack(int index) {
+        if (tracks.empty()) return;
+        requested.store(index % static_cast<int>(tracks.size()), std::memory_order_relaxed);
+    }
+
+    bool Running() const {
+        return running.load(std::memory_order_relaxed);
+    }
+
+    Stats GetStats() const {
+        Stats s;
+        s.underruns = counters.underruns.load(std::memory_order_relaxed);
+        s.underrunFrames = counters.underrunFrames.load(std::memory_order_relaxed);
+        s.chunks = counters.chunks.load(std::memory_order_relaxed);
+        s.decodeNs = counters.decodeNs.load(std::memory_order_relaxed);
+        s.maxDecodeNs = counters.maxDecodeNs.load(std::memory_order_relaxed);
+        s.bufferedFrames = static_cast<int>(ring.Size());
+        s.minBufferedFrames = counters.minBuffered.load(std::memory_order_relaxed);
+        s.prefetchFrames = prefetchFrames;
+        s.tracks = static_cast<int>(tracks.size());
+        s.track = counters.track.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    MusicStreamer() {
+        SetPrefetch(DEFAULT_PREFETCH_MS);
+    }
+
+    static constexpr int DECODE_FRAMES = 1'024;  // Output frames per decoder step
+    static constexpr int SOURCE_FRAMES = 1'024;  // Source frames per DecodeMusicStream call
+    static constexpr float MUSIC_GAIN = 0.6f;
+    static constexpr auto DECODER_SLEEP = std::chrono::milliseconds(5);
+
+    // Stereo float frames from the decoder thread to the audio thread.
+    class FrameRing {
+    public:
+        void Allocate(size_t frames) {
+            capacity = std::bit_ceil(frames);
+            samples.assign(capacity * 2, 0.f);
+            writeIndex.store(0, std::memory_order_relaxed);
+            readIndex.store(0, std::memory_order_relaxed);
+        }
+
+        size_t Size() const {
+            return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+        }
+
+        // Producer; the caller keeps Size() + count within the capacity.
+        void Write(const float* frames, size_t count) {
+            size_t tail = writeIndex.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < count; i++) {
+                size_t slot = ((tail + i) & (capacity - 1)) * 2;
+                samples[slot] = frames[i * 2];
+                samples[slot + 1] = frames[i * 2 + 1];
+            }
+            writeIndex.store(tail + count, std::memory_order_release);
+        }
+
+        // Consumer; returns the frames read, up to 'count'.
+        size_t Read(float* frames, size_t count) {
+            size_t head = readIndex.load(std::memory_order_relaxed);
+            count = std::min(count, writeIndex.load(std::memory_order_acquire) - head);
+            for (size_t i = 0; i < count; i++) {
+                size_t slot = ((head + i) & (capacity - 1)) * 2;
+                frames[i * 2] = samples[slot];
+                frames[i * 2 + 1] = samples[slot + 1];
+            }
+            readIndex.store(head + count, std::memory_order_release);
+            return count;
+        }
+
+    private:
+        std::vector<float> samples;
+        size_t capacity = 0;
+        alignas(64) std::atomic<size_t> writeIndex{ 0 };
+        alignas(64) std::atomic<size_t> readIndex{ 0 };
+    };
+
+    // A decoder and its linear resampler; decoder thread only.
+    struct Track {
+        Music music = {};
+        float step = 1.f;         // Source frames per output frame
+        float position = 1.f;     // Between 'from' (0) and 'to' (1)
+        float from[2] = {};
+        float to[2] = {};
+        std::vector<uint8_t> raw; // Decoder output in the stream's format
+        std::vector<float> source;
+        size_t sourceFrames = 0;
+        size_t sourceCursor = 0;
+    };
+
+    // Written by the decoder (chunks, decode times, track) and audio threads
+    struct Counters {
+        std::atomic<uint64_t> underruns{ 0 };
+        std::atomic<uint64_t> underrunFrames{ 0 };
+        std::atomic<uint64_t> chunks{ 0 };
+        std::atomic<uint64_t> decodeNs{ 0 };
+        std::atomic<uint64_t> maxDecodeNs{ 0 };
+        std::atomic<int>      minBuffered{ 0 };
+        std::atomic<int>      track{ -1 };
+    };
+
+    void UnloadTracks() {
+        for (Track& track : tracks) UnloadMusicStream(track.music);
+        tracks.clear();
+    }
+
+    void DecodeLoop() {
+        while (running.load(std::memory_order_acquire)) {
+            if (ring.Size() + DECODE_FRAMES > static_cast<size_t>(prefetchFrames)) {
+                std::this_thread::sleep_for(DECODER_SLEEP);
+                continue;
+            }
+            auto start = std::chrono::steady_clock::now();
+            DecodeChunk();
+            ring.Write(chunk, DECODE_FRAMES);
+
+            uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            counters.chunks.fetch_add(1, std::memory_order_relaxed);
+            counters.decodeNs.fetch_add(ns, std::memory_order_relaxed);
+            if (ns > counters.maxDecodeNs.load(std::memory_order_relaxed)) counters.maxDecodeNs.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    // Next DECODE_FRAMES of the current track into 'chunk', crossfaded with
+    // equal power from the previous one while a fade runs.
+    void DecodeChunk() {
+        int wanted = requested.load(std::memory_order_relaxed);
+        if (fadeFrom < 0 && wanted != current && wanted < static_cast<int>(tracks.size())) {
+            fadeFrom = current;
+            current = wanted;
+            fadePosition = 0;
+            counters.track.store(current, std::memory_order_relaxed);
+        }
+
+        Resample(tracks[current], chunk, DECODE_FRAMES);
+        if (fadeFrom < 0) return;
+
+        Resample(tracks[fadeFrom], fadeChunk, DECODE_FRAMES);
+        const int fadeFrames = static_cast<int>(CROSSFADE_SECONDS * SAMPLE_RATE);
+        for (int i = 0; i < DECODE_FRAMES; i++) {
+            float x = std::min(static_cast<float>(fadePosition + i) / fadeFrames, 1.f) * (PI / 2.f);
+            float in = sinf(x), out = cosf(x);
+            chunk[i * 2] = chunk[i * 2] * in + fadeChunk[i * 2] * out;
+            chunk[i * 2 + 1] = chunk[i * 2 + 1] * in + fadeChunk[i * 2 + 1] * out;
+        }
+        fadePosition += DECODE_FRAMES;
+        if (fadePosition >= fadeFrames) fadeFrom = -1;  // The old track pauses where it is
+    }
+
+    // 'frames' output frames of 'track', linearly interpolated between source frames.
+    static void Resample(Track& track, float* out, int frames) {
+        for (int i = 0; i < frames; i++) {
+            while (track.position >= 1.f) {
+                track.position -= 1.f;
+                if (track.sourceCursor == track.sourceFrames) Refill(track);
+                track.from[0] = track.to[0];
+                track.from[1] = track.to[1];
+                track.to[0] = track.source[track.sourceCursor * 2];
+                track.to[1] = track.source[track.sourceCursor * 2 + 1];
+                track.sourceCursor++;
+            }
+            out[i * 2] = track.from[0] + (track.to[0] - track.from[0]) * track.position;
+            out[i * 2 + 1] = track.from[1] + (track.to[1] - track.from[1]) * track.position;
+            track.position += track.step;
+        }
+    }
+
+    // Decodes the next source frames as float stereo.
+    static void Refill(Track& track) {
+        const Music& music = track.music;
+        unsigned int frames = DecodeMusicStream(music, track.raw.data(), SOURCE_FRAMES);
+        int channels = static_cast<int>(music.stream.channels);
+        bool isFloat = music.stream.sampleSize == 32;
+        auto sample = [&](size_t index) {
+            return isFloat ? reinterpret_cast<const float*>(track.raw.data())[index]
+                           : reinterpret_cast<const int16_t*>(track.raw.data())[index] / 32768.f;
+        };
+        for (unsigned int i = 0; i < frames; i++) {
+            track.source[i * 2] = sample(i * channels);
+            track.source[i * 2 + 1] = sample(i * channels + (channels > 1 ? 1 : 0));
+        }
+        if (frames == 0) {
+            // Undecodable: silence rather than a stall
+            track.source[0] = track.source[1] = 0.f;
+            frames = 1;
+        }
+        track.sourceFrames = frames;
+        track.sourceCursor = 0;
+    }
+
+    // Audio thread from here on.
+    static void MixCallback(void* buffer, unsigned int frames) {
+        Instance().Mix(static_cast<float*>(buffer), frames);
+    }
+
+    void Mix(float* out, unsigned int frames) {
+        size_t read = ring.Read(out, frames);
+        std::fill(out + read * 2, out + frames * 2, 0.f);
+        for (size_t i = 0; i < read * 2; i++) out[i] *= MUSIC_GAIN;
+
+        // Silence before the decoder first caught up is start-up, not an underrun
+        if (read == frames && !primed) {
+            primed = true;
+            counters.minBuffered.store(static_cast<int>(ring.Size()), std::memory_order_relaxed);
+        }
+        if (!primed) return;
+        if (read < frames) {
+            counters.underruns.fetch_add(1, std::memory_order_relaxed);
+            counters.underrunFrames.fetch_add(frames - read, std::memory_order_relaxed);
+        }
+        int buffered = static_cast<int>(ring.Size());
+        if (buffered < counters.minBuffered.load(std::memory_order_relaxed)) {
+            counters.minBuffered.store(buffered, std::memory_order_relaxed);
+        }
+    }
+
+    std::vector<Track> tracks;
+    FrameRing ring;
+    float chunk[DECODE_FRAMES * 2] = {};
+    float fadeChunk[DECODE_FRAMES * 2] = {};
+    int prefetchFrames = 0;
+    int current = 0;       // Decoder thread
+    int fadeFrom = -1;     // Decoder thread; -1: no crossfade
+    int fadePosition = 0;  // Frames into the crossfade
+    bool primed = false;   // Audio thread
+    std::atomic<int> requested{ 0 };
+    std::atomic<bool> running{ false };
+    std::thread decoder;
+    Counters counters;
+    AudioStream stream = {};
+};
+
+// --- INPUT ---
+// Game buttons as a bit set, so one tick of input is a couple of integers
+// regardless of where it came from (keyboard, script, recording).
+enum InputButton : uint16_t {
+    BTN_UP            = 1 << 0,
+    BTN_DOWN          = 1 << 1,
+    BTN_LEFT          = 1 << 2,
+    BTN_RIGHT         = 1 << 3,
+    BTN_FIRE          = 1 << 4,
+    BTN_SWITCH_WEAPON = 1 << 5,
+    BTN_RESTART       = 1 << 6,
+    BTN_SHAPE_1       = 1 << 7,
+    BTN_SHAPE_2       = 1 << 8,
+    BTN_SHAPE_3       = 1 << 9,
+    BTN_SHAPE_4       = 1 << 10,
+    BTN_SHAPE_5       = 1 << 11,
+};
+
+struct InputState {
+    uint16_t down = 0;
+    uint16_t pressed = 0;
+
+    bool Down(InputButton b) const {
+        return (down & b) != 0;
+    }
+
+    bool Pressed(InputButton b) const {
+        return (pressed & b) != 0;
+    }
+
+    static InputState FromKeyboard() {
+        static constexpr struct { int key; InputButton button; } bindings[] = {
+            { KEY_W, BTN_UP }, { KEY_S, BTN_DOWN }, { KEY_A, BTN_LEFT }, { KEY_D, BTN_RIGHT },
+            { KEY_SPACE, BTN_FIRE }, { KEY_TAB, BTN_SWITCH_WEAPON }, { KEY_R, BTN_RESTART },
+            { KEY_ONE, BTN_SHAPE_1 }, { KEY_TWO, BTN_SHAPE_2 }, { KEY_THREE, BTN_SHAPE_3 },
+            { KEY_FOUR, BTN_SHAPE_4 }, { KEY_FIVE, BTN_SHAPE_5 },
+        };
+        InputState state;
+        for (const auto& b : bindings) {
+            if (IsKeyDown(b.key)) state.down |= b.button;
+            if (IsKeyPressed(b.key)) state.pressed |= b.button;
+        }
+        return state;
+    }
+};
+
+// --- INPUT RECORDING ---
+// Replay file: everything needed to re-run a session tick for tick.
+//   header    : magic "AREC", version, seed (u64), tick rate, checksum interval,
+//               tick count, run count, checksum count (u32 unless noted)
+//   runs      : u16 down, u16 pressed, varint length - one per run of identical ticks
+//   checksums : u32 tick, u64 world hash - one every 'checksum interval' ticks
+// Little endian throughout.
+namespace ReplayFormat {
+    constexpr uint32_t MAGIC = 0x43455241;  // "AREC"
+    constexpr uint32_t VERSION = 1;
+
+    // 64-bit FNV-1a, used for the world-state checksums.
+    constexpr uint64_t FNV_OFFSET = 0xCBF29CE484222325ull;
+
+    inline uint64_t Hash(uint64_t h, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            h = (h ^ bytes[i]) * 0x100000001B3ull;
+        }
+        return h;
+    }
+
+    template <typename T>
+    uint64_t Hash(uint64_t h, const T& value) {
+        return Hash(h, &value, sizeof(T));
+    }
+}
+
+struct ReplayChecksum {
+    uint32_t tick;
+    uint64_t value;
+};
+
+class InputRecorder {
+public:
+    InputRecorder(uint64_t seed, int tickRate, int checksumInterval)
+        : seed(seed), tickRate(tickRate), checksumInterval(checksumInterval) {}
+
+    int ChecksumInterval() const {
+        return checksumInterval;
+    }
+
+    void Record(const InputState& input) {
+        if (runLength > 0 && (input.down != runInput.down || input.pressed != runInput.pressed)) {
+            FlushRun();
+        }
+        runInput = input;
+        runLength++;
+        tickCount++;
+    }
+
+    void RecordChecksum(uint32_t tick, uint64_t value) {
+        checksums.push_back({ tick, value });
+    }
+
+    bool Save(const char* path) {
+        if (runLength > 0) FlushRun();
+
+        std::vector<uint8_t> file;
+        file.reserve(32 + runBytes.size() + checksums.size() * 12);
+        Put(file, ReplayFormat::MAGIC);
+        Put(file, ReplayFormat::VERSION);
+        Put(file, seed);
+        Put(file, static_cast<uint32_t>(tickRate));
+        Put(file, static_cast<uint32_t>(checksumInterval));
+        Put(file, tickCount);
+        Put(file, runCount);
+        Put(file, static_cast<uint32_t>(checksums.size()));
+        file.insert(file.end(), runBytes.begin(), runBytes.end());
+        for (const ReplayChecksum& c : checksums) {
+            Put(file, c.tick);
+            Put(file, c.value);
+        }
+        return SaveFileData(path, file.data(), static_cast<int>(file.size()));
+    }
+
+private:
+    template <typename T>
+    static void Put(std::vector<uint8_t>& out, T value) {
+        for (size_t i = 0; i < sizeof(T); i++) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void FlushRun() {
+        Put(runBytes, runInput.down);
+        Put(runBytes, runInput.pressed);
+        for (uint32_t v = runLength; ; v >>= 7) {
+            if (v < 0x80) {
+                runBytes.push_back(static_cast<uint8_t>(v));
+                break;
+            }
+            runBytes.push_back(static_cast<uint8_t>((v & 0x7F) | 0x80));
+        }
+        runCount++;
+        runLength = 0;
+    }
+
+    uint64_t seed;
+    int      tickRate;
+    int      checksumInterval;
+    uint32_t tickCount = 0;
+    uint32_t runCount = 0;
+
+    InputState runInput;
+    uint32_t   runLength = 0;
+    std::vector<uint8_t> runBytes;
+    std::vector<ReplayChecksum> checksums;
+};
+
+class InputReplay {
+public:
+    bool Load(const char* path) {
+        int size = 0;
+        unsigned char* data = LoadFileData(path, &size);
+        if (!data) return false;
+        bytes.assign(data, data + size);
+        UnloadFileData(data);
+
+        cursor = 0;
+        uint32_t magic = 0, version = 0, rate = 0, interval = 0, checksumCount = 0;
+        if (!Get(magic) || magic != ReplayFormat::MAGIC || !Get(version) || version != ReplayFormat::VERSION) {
+            TraceLog(LOG_WARNING, "REPLAY: [%s] is not a replay file", path);
+            return false;
+        }
+        if (!Get(seed) || !Get(rate) || !Get(interval) || !Get(tickCount) || !Get(runsLeft) || !Get(checksumCount)) {
+            return false;
+        }
+        tickRate = static_cast<int>(rate);
+        checksumInterval = static_cast<int>(interval);
+
+        // Checksums sit after the runs; decode the runs once to find them.
+        size_t runsStart = cursor;
+        for (uint32_t i = 0; i < runsLeft; i++) {
+            uint16_t down, pressed;
+            uint32_t length;
+            if (!Get(down) || !Get(pressed) || !GetVarint(length)) return false;
+        }
+        checksums.resize(checksumCount);
+        for (ReplayChecksum& c : checksums) {
+            if (!Get(c.tick) || !Get(c.value)) return false;
+        }
+        cursor = runsStart;
+        runLength = 0;
+        return true;
+    }
+
+    uint64_t Seed() const {
+        return seed;
+    }
+
+    int TickRate() const {
+        return tickRate;
+    }
+
+    uint32_t TickCount() const {
+        return tickCount;
+    }
+
+    // Input for the next tick; false once the recording is exhausted.
+    bool Next(InputState& out) {
+        while (runLength == 0) {
+            if (runsLeft == 0) return false;
+            Get(runInput.down);
+            Get(runInput.pressed);
+            GetVarint(runLength);
+            runsLeft--;
+        }
+        runLength--;
+        out = runInput;
+        return true;
+    }
+
+    // Compares the world checksum after 'tick' ticks against the recording.
+    void Verify(uint32_t tick, uint64_t value) {
+        if (checksumInterval <= 0 || tick % checksumInterval != 0) return;
+        size_t index = tick / checksumInterval - 1;
+        if (index >= checksums.size() || checksums[index].tick != tick) return;
+        if (checksums[index].value == value) {
+            verified++;
+        }
+        else {
+            if (failed == 0) firstMismatchTick = tick;
+            failed++;
+        }
+    }
+
+    int Verified() const {
+        return verified;
+    }
+
+    int Failed() const {
+        return failed;
+    }
+
+    uint32_t FirstMismatchTick() const {
+        return firstMismatchTick;
+    }
+
+    int ChecksumCount() const {
+        return static_cast<int>(checksums.size());
+    }
+
+private:
+    template <typename T>
+    bool Get(T& value) {
+        if (cursor + sizeof(T) > bytes.size()) return false;
+        value = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            value |= static_cast<T>(static_cast<T>(bytes[cursor++]) << (8 * i));
+        }
+        return true;
+    }
+
+    bool GetVarint(uint32_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 35 && cursor < bytes.size(); shift += 7) {
+            uint8_t b = bytes[cursor++];
+            value |= static_cast<uint32_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    std::vector<uint8_t> bytes;
+    size_t   cursor = 0;
+    uint64_t seed = 0;
+    int      tickRate = 0;
+    int      checksumInterval = 0;
+    uint32_t tickCount = 0;
+    uint32_t runsLeft = 0;
+
+    InputState runInput;
+    uint32_t   runLength = 0;
+    std::vector<ReplayChecksum> checksums;
+
+    int      verified = 0;
+    int      failed = 0;
+    uint32_t firstMismatchTick = 0;
+};
+
+// --- JOB SYSTEM ---
+// Small work-stealing scheduler. Every thread owns a lock-free queue; it pushes
+// and pops its own work at the back and steals from the front of the others'.
+// A thread that waits for work to finish keeps running jobs meanwhile, so jobs
+// may wait on jobs of their own. With one thread everything runs inline on the
+// caller in a fixed order, which keeps debugging deterministic.
+namespace Jobs {
+    struct Job {
+        void (*run)(const void* context, size_t begin, size_t end) = nullptr;
+        const void* context = nullptr;
+        size_t begin = 0;
+        size_t end = 0;
+        std::atomic<int>* pending = nullptr;  // Decremented once the job has run
+    };
+
+    // Bounded Chase-Lev deque (Le et al., "Correct and efficient work-stealing
+    // for weak memory models"). Only the owning thread calls Push and Pop, which
+    // take no lock and only contend with thieves over the last job. Steal may
+    // be called from any thread and fails when it loses a race.
+    class WorkQueue {
+    public:
+        bool Push(const Job& job) {
+            int64_t b = bottom.load(std::memory_order_relaxed);
+            int64_t t = top.load(std::memory_order_acquire);
+            if (b - t >= CAPACITY) return false;
+            slots[b % CAPACITY].Store(job);
+            bottom.store(b + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool Pop(Job& out) {
+            // Claim the bottom job before looking at 'top'; seq_cst orders the
+            // two against a thief doing the reverse
+            int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_seq_cst);
+            int64_t t = top.load(std::memory_order_seq_cst);
+            if (t > b) {
+                bottom.store(b + 1, std::memory_order_release);
+                return false;
+            }
+            out = slots[b % CAPACITY].Load();
+            if (t == b) {
+                // Last job: race the thieves for it
+                bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                bottom.store(b + 1, std::memory_order_release);
+                return won;
+            }
+            return true;
+        }
+
+        bool Steal(Job& out) {
+            int64_t t = top.load(std::memory_order_seq_cst);
+            int64_t b = bottom.load(std::memory_order_seq_cst);
+            if (t >= b) return false;
+            out = slots[t % CAPACITY].Load();
+            return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        }
+
+    private:
+        // A thief may read a slot while the owner refills it after wrapping
+        // around; its CAS on 'top' then fails and the torn copy is dropped.
+        // Relaxed atomics keep that read well-defined.
+        struct Slot {
+            std::atomic<void (*)(const void*, size_t, size_t)> run{ nullptr };
+            std::atomic<const void*> context{ nullptr };
+            std::atomic<size_t> begin{ 0 };
+            std::atomic<size_t> end{ 0 };
+            std::atomic<std::atomic<int>*> pending{ nullptr };
+
+            void Store(const Job& job) {
+                run.store(job.run, std::memory_order_relaxed);
+                context.store(job.context, std::memory_order_relaxed);
+                begin.store(job.begin, std::memory_order_relaxed);
+                end.store(job.end, std::memory_order_relaxed);
+                pending.store(job.pending, std::memory_order_relaxed);
+            }
+
+            Job Load() const {
+                Job job;
+                job.run = run.load(std::memory_order_relaxed);
+                job.context = context.load(std::memory_order_relaxed);
+                job.begin = begin.load(std::memory_order_relaxed);
+                job.end = end.load(std::memory_order_relaxed);
+                job.pending = pending.load(std::memory_order_relaxed);
+                return job;
+            }
+        };
+
+        static constexpr int64_t CAPACITY = 1024;
+
+        // Owner end and thief end on separate cache lines
+        alignas(64) std::atomic<int64_t> top{ 0 };
+        alignas(64) std::atomic<int64_t> bottom{ 0 };
+        alignas(64) Slot slots[CAPACITY];
+    };
+
+    class Scheduler {
+    public:
+        static Scheduler& Instance() {
+            static Scheduler instance;
+            return instance;
+        }
+
+        ~Scheduler() {
+            Stop();
+        }
+
+        // Starts 'threadCount - 1' workers next to the calling thread; 0 uses every core.
+        void Start(int threadCount) {
+            Stop();
+            if (threadCount <= 0) {
+                threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            }
+            queues.clear();
+            for (int i = 0; i < threadCount; i++) {
+                queues.push_back(std::make_unique<WorkQueue>());
+            }
+            running = true;
+            for (int i = 1; i < threadCount; i++) {
+                workers.emplace_back([this, i] { WorkerLoop(i); });
+            }
+        }
+
+        void Stop() {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                running = false;
+            }
+            wake.notify_all();
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+            workers.clear();
+        }
+
+        int ThreadCount() const {
+            return static_cast<int>(workers.size()) + 1;
+        }
+
+        void Submit(const Job& job) {
+            queued.fetch_add(1, std::memory_order_release);
+            if (!queues[self]->Push(job)) {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                Execute(job);
+                return;
+            }
+            if (!workers.empty()) {
+                { std::lock_guard<std::mutex> lock(sleepMutex); }
+                wake.notify_one();
+            }
+        }
+
+        // Runs queued jobs until 'pending' drops to zero.
+        void Wait(const std::atomic<int>& pending) {
+            while (pending.load(std::memory_order_acquire) > 0) {
+                if (!RunOne()) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        // Calls fn(begin, end) over [0, count) in chunks of 'grain' items spread
+        // across the threads, and returns once every chunk has run.
+        template <typename F>
+        void ParallelFor(size_t count, size_t grain, F&& fn) {
+            using Fn = std::remove_reference_t<F>;
+            grain = std::max<size_t>(grain, 1);
+            if (count <= grain || workers.empty()) {
+                if (count > 0) fn(size_t{ 0 }, count);
+                return;
+            }
+
+            size_t chunks = (count + grain - 1) / grain;
+            std::atomic<int> pending{ static_cast<int>(chunks) };
+            Job job;
+            job.run = [](const void* context, size_t begin, size_t end) {
+                PROFILE_ZONE("chunk");
+                (*static_cast<const Fn*>(context))(begin, end);
+            };
+            job.context = &fn;
+            job.pending = &pending;
+            // Queue all but the first chunk for thieves, run the first right here
+            for (size_t c = chunks; c-- > 1;) {
+                job.begin = c * grain;
+                job.end = std::min(count, job.begin + grain);
+                Submit(job);
+            }
+            fn(size_t{ 0 }, grain);
+            pending.fetch_sub(1, std::memory_order_release);
+            Wait(pending);
+        }
+
+    private:
+        Scheduler() {
+            queues.push_back(std::make_unique<WorkQueue>());
+        }
+
+        static void Execute(const Job& job) {
+            job.run(job.context, job.begin, job.end);
+            job.pending->fetch_sub(1, std::memory_order_release);
+        }
+
+        bool RunOne() {
+            Job job;
+            bool found = queues[self]->Pop(job);
+            for (size_t k = 1; !found && k < queues.size(); k++) {
+                found = queues[(self + k) % queues.size()]->Steal(job);
+            }
+            if (!found) return false;
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            Execute(job);
+            return true;
+        }
+
+        void WorkerLoop(int index) {
+            self = index;
+            PROFILE_THREAD("worker", index);
+            while (true) {
+                if (RunOne()) continue;
+                // Spin briefly before sleeping: work arrives in bursts every tick
+                bool found = false;
+                for (int spin = 0; spin < SPIN_COUNT && !found; spin++) {
+                    std::this_thread::yield();
+                    found = queued.load(std::memory_order_acquire) > 0;
+                }
+                if (found) continue;
+
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                wake.wait(lock, [this] { return !running || queued.load(std::memory_order_acquire) > 0; });
+                if (!running) return;
+            }
+        }
+
+        static constexpr int SPIN_COUNT = 2000;
+
+        static inline thread_local size_t self = 0;  // Queue of the current thread, 0 = the one that called Start
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        std::vector<std::thread> workers;
+        std::atomic<int> queued{ 0 };
+        bool running = false;
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+    };
+
+    // Fixed set of tasks with "runs after" edges, built once and run once per
+    // frame. Tasks whose dependencies have finished are handed to the scheduler
+    // as soon as they become ready, so independent ones overlap.
+    class TaskGraph {
+    public:
+        // 'fn' is stored inline in the task and called through a plain function
+        // pointer, so it has to be a small capture such as [this].
+        template <typename F>
+        int Add(const char* name, F fn) {
+            static_assert(sizeof(F) <= sizeof(Task::storage) && alignof(F) <= alignof(void*), "task captures too much");
+            static_assert(std::is_trivially_copyable_v<F> && std::is_trivially_destructible_v<F>, "task captures must be trivial");
+            auto task = std::make_unique<Task>();
+            task->name = name;
+            new (task->storage) F(fn);
+            task->call = [](void* storage) { (*std::launder(static_cast<F*>(storage)))(); };
+            task->graph = this;
+            tasks.push_back(std::move(task));
+            return static_cast<int>(tasks.size()) - 1;
+        }
+
+        // 'after' starts only once 'before' has finished.
+        void Precede(int before, int after) {
+            tasks[before]->successors.push_back(after);
+            tasks[after]->dependencies++;
+        }
+
+        void Run() {
+            pending.store(static_cast<int>(tasks.size()), std::memory_order_relaxed);
+            for (auto& task : tasks) {
+                task->remaining.store(task->dependencies, std::memory_order_relaxed);
+            }
+            for (auto& task : tasks) {
+                if (task->dependencies == 0) Schedule(*task);
+            }
+            Scheduler::Instance().Wait(pending);
+        }
+
+        const char* Name(int task) const {
+            return tasks[task]->name;
+        }
+
+    private:
+        struct Task {
+            const char* name = "";
+            void (*call)(void* storage) = nullptr;
+            alignas(void*) unsigned char storage[2 * sizeof(void*)];
+            std::vector<int> successors;
+            int dependencies = 0;
+            std::atomic<int> remaining{ 0 };
+            TaskGraph* graph = nullptr;
+        };
+
+        void Schedule(Task& task) {
+            Job job;
+            job.run = [](const void* context, size_t, size_t) {
+                Task& t = *static_cast<Task*>(const_cast<void*>(context));
+                {
+                    PROFILE_ZONE(t.name);
+                    t.call(t.storage);
+                }
+                for (int next : t.successors) {
+                    Task& successor = *t.graph->tasks[next];
+                    if (successor.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        t.graph->Schedule(successor);
+                    }
+                }
+            };
+            job.context = &task;
+            job.pending = &pending;
+            Scheduler::Instance().Submit(job);
+        }
+
+        std::vector<std::unique_ptr<Task>> tasks;
+        std::atomic<int> pending{ 0 };
+    };
+}
+
+// --- ENTITY STORE ---
+// Stable reference to an entity. Survives swap-removes of other entities and
+// goes stale (Slot() returns npos) once its own entity is removed.
+struct EntityHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// Slots hit during a tick. Collision queries mark entities here instead of
+// removing them, and the store drops all of them at once afterwards.
+class KillList {
+public:
+    void Reserve(size_t n) {
+        marked.reserve(n);
+        slots.reserve(n);
+    }
+
+    // Empties the list for a store that currently holds 'size' slots.
+    void Reset(size_t size) {
+        marked.assign(size, 0);
+        slots.clear();
+    }
+
+    bool Contains(size_t slot) const {
+        return marked[slot] != 0;
+    }
+
+    void Add(size_t slot) {
+        if (marked[slot]) return;
+        marked[slot] = 1;
+        slots.push_back(static_cast<uint32_t>(slot));
+    }
+
+    // Highest slot first, the order EntityStore::Remove needs.
+    const std::vector<uint32_t>& Sorted() {
+        std::sort(slots.begin(), slots.end(), std::greater<uint32_t>());
+        return slots;
+    }
+
+private:
+    std::vector<uint8_t>  marked;
+    std::vector<uint32_t> slots;
+};
+
+// Dense struct-of-arrays storage shared by every entity kind. 'Columns' owns the
+// per-entity arrays and lists them in ForEachColumn; the store keeps them packed
+// by moving the last slot into the hole on removal, and maps handles to slots.
+// The store is a fixed-size pool: SetCapacity allocates everything up front and
+// Add() fails once it is full, so nothing is allocated while the game runs.
+template <typename Columns>
+class EntityStore : public Columns {
+public:
+    static constexpr size_t npos = SIZE_MAX;
+
+    size_t Size() const {
+        return slotOwner.size();
+    }
+
+    bool Empty() const {
+        return slotOwner.empty();
+    }
+
+    size_t Capacity() const {
+        return capacity;
+    }
+
+    void SetCapacity(size_t n) {
+        capacity = n;
+        this->ForEachColumn([n](auto& column) { column.reserve(n); });
+        slotOwner.reserve(n);
+        handleSlot.reserve(n);
+        generation.reserve(n);
+        freeHandles.reserve(n);
+    }
+
+    // Appends a value-initialized slot and returns its index, or npos when the
+    // pool is full; the caller fills the columns.
+    size_t Add() {
+        size_t slot = Size();
+        if (slot >= capacity) return npos;
+        this->ForEachColumn([](auto& column) { column.emplace_back(); });
+
+        uint32_t h;
+        if (!freeHandles.empty()) {
+            h = freeHandles.back();
+            freeHandles.pop_back();
+        }
+        else {
+            h = static_cast<uint32_t>(handleSlot.size());
+            handleSlot.push_back(0);
+            generation.push_back(0);
+        }
+        handleSlot[h] = static_cast<uint32_t>(slot);
+        slotOwner.push_back(h);
+        return slot;
+    }
+
+    void RemoveAt(size_t slot) {
+        size_t last = Size() - 1;
+        Release(slotOwner[slot]);
+        if (slot != last) {
+            this->ForEachColumn([slot, last](auto& column) { column[slot] = column[last]; });
+            slotOwner[slot] = slotOwner[last];
+            handleSlot[slotOwner[slot]] = static_cast<uint32_t>(slot);
+        }
+        this->ForEachColumn([](auto& column) { column.pop_back(); });
+        slotOwner.pop_back();
+    }
+
+    // Removes every slot in 'kills'. Goes from the highest slot down, so the
+    // slot moved into a hole is never one that is still waiting for removal.
+    void Remove(KillList& kills) {
+        for (uint32_t slot : kills.Sorted()) {
+            RemoveAt(slot);
+        }
+    }
+
+    // Removes every slot set in a packed bit mask (bit i%8 of mask[i/8]), as
+    // produced by Kernels::CullOutside. Skips whole bytes of survivors.
+    void RemoveMasked(const uint8_t* mask) {
+        for (size_t byte = (Size() + 7) / 8; byte-- > 0;) {
+            unsigned bits = mask[byte];
+            while (bits) {
+                int bit = std::bit_width(bits) - 1;
+                RemoveAt(byte * 8 + bit);
+                bits &= ~(1u << bit);
+            }
+        }
+    }
+
+    void Clear() {
+        for (uint32_t h : slotOwner) {
+            Release(h);
+        }
+        this->ForEachColumn([](auto& column) { column.clear(); });
+        slotOwner.clear();
+    }
+
+    // Folds the raw bytes of every column into an FNV-1a hash.
+    uint64_t Checksum(uint64_t h) const {
+        // ForEachColumn only reads here; the columns have no const overload.
+        const_cast<EntityStore*>(this)->ForEachColumn([&h](const auto& column) {
+            h = ReplayFormat::Hash(h, column.data(), column.size() * sizeof(column[0]));
+        });
+        return h;
+    }
+
+    EntityHandle Handle(size_t slot) const {
+        uint32_t h = slotOwner[slot];
+        return { h, generation[h] };
+    }
+
+    size_t Slot(EntityHandle handle) const {
+        if (handle.index >= generation.size() || generation[handle.index] != handle.generation) return npos;
+        return handleSlot[handle.index];
+    }
+
+private:
+    void Release(uint32_t h) {
+        generation[h]++;
+        freeHandles.push_back(h);
+    }
+
+    std::vector<uint32_t> slotOwner;   // slot -> handle index
+    std::vector<uint32_t> handleSlot;  // handle index -> slot
+    std::vector<uint32_t> generation;  // handle index -> generation
+    std::vector<uint32_t> freeHandles;
+    size_t capacity = SIZE_MAX;
+};
+
+// --- ASTEROIDS ---
+// Shape selector
+enum class AsteroidShape { TRIANGLE = 3, SQUARE = 4, PENTAGON = 5, STAR = 6, RANDOM = 0 };
+
+struct AsteroidColumns {
+    std::vector<float>   posX, posY;
+    std::vector<float>   prevX, prevY, prevRotation;  // state at the start of the tick
+    std::vector<float>   velX, velY;
+    std::vector<float>   rotation, rotationSpeed;
+    std::vector<float>   radius;
+    std::vector<uint8_t> size;   // Renderable::Size
+    std::vector<uint8_t> shape;  // AsteroidShape
+
+    template <typename F>
+    void ForEachColumn(F&& f) {
+        f(posX); f(posY);
+        f(prevX); f(prevY); f(prevRotation);
+        f(velX); f(velY);
+        f(rotation); f(rotationSpeed);
+        f(radius);
+        f(size); f(shape);
+    }
+};
+
+class AsteroidStore : public EntityStore<AsteroidColumns> {
+public:
+    // Random draws consumed by one spawn; a wave of n asteroids uses n * SPAWN_DRAWS.
+    static constexpr size_t SPAWN_DRAWS = 9;
+
+    // Spawns an asteroid at a random screen edge, aimed towards the center.
+    size_t Spawn(RandomStream& rng, int screenW, int screenH, AsteroidShape shp, float speedMultiplier) {
+        float u[SPAWN_DRAWS];
+        rng.FillFloats(u, SPAWN_DRAWS, 0.f, 1.f);
+        return SpawnFrom(u, screenW, screenH, shp, speedMultiplier);
+    }
+
+    // Spawns 'count' asteroids with every random number drawn in one call.
+    void SpawnWave(RandomStream& rng, size_t count, int screenW, int screenH, AsteroidShape shp, float speedMultiplier) {
+        waveDraws.resize(count * SPAWN_DRAWS);
+        rng.FillFloats(waveDraws.data(), waveDraws.size(), 0.f, 1.f);
+        for (size_t k = 0; k < count; k++) {
+            SpawnFrom(&waveDraws[k * SPAWN_DRAWS], screenW, screenH, shp, speedMultiplier);
+        }
+    }
+
+    void SetCapacity(size_t n) {
+        EntityStore::SetCapacity(n);
+        deadMask.reserve((n + 7) / 8);
+        waveDraws.reserve(n * SPAWN_DRAWS);
+    }
+
+    void SavePrevious() {
+        prevX = posX;
+        prevY = posY;
+        prevRotation = rotation;
+    }
+
+    // Moves every asteroid and removes the ones that left the screen.
+    void Update(float dt, float screenW, float screenH) {
+        deadMask.resize((Size() + 7) / 8);
+        std::atomic<size_t> dead{ 0 };
+        Jobs::Scheduler::Instance().ParallelFor(Size(), Kernels::CHUNK, [&](size_t begin, size_t end) {
+            size_t n = end - begin;
+            Kernels::Integrate(&posX[begin], &velX[begin], n, dt);
+            Kernels::Integrate(&posY[begin], &velY[begin], n, dt);
+            Kernels::Integrate(&rotation[begin], &rotationSpeed[begin], n, dt);
+            dead += Kernels::CullOutside(&posX[begin], &posY[begin], &radius[begin], n,
+                0.f, 0.f, screenW, screenH, &deadMask[begin / 8]);
+        });
+        if (dead) {
+            RemoveMasked(deadMask.data());
+        }
+    }
+
+    void Draw(float alpha) const;
+
+    static float RadiusOf(int sz) {
+        return 16.f * (float)sz;
+    }
+
+    static constexpr float SPEED_MIN = 125.f;
+    static constexpr float SPEED_MAX = 250.f;
+    static constexpr float ROT_MIN = 50.f;
+    static constexpr float ROT_MAX = 240.f;
+
+private:
+    // Builds one asteroid from SPAWN_DRAWS uniform numbers in [0, 1).
+    size_t SpawnFrom(const float* u, int screenW, int screenH, AsteroidShape shp, float speedMultiplier) {
+        if (shp == AsteroidShape::RANDOM) {
+            shp = static_cast<AsteroidShape>(3 + static_cast<int>(u[0] * 4));
+        }
+
+        size_t i = Add();
+        if (i == npos) return npos;
+        shape[i] = static_cast<uint8_t>(shp);
+
+        // Choose size
+        size[i] = static_cast<uint8_t>(1 << static_cast<int>(u[1] * 3));
+        radius[i] = RadiusOf(size[i]);
+        float r = radius[i];
+
+        // Spawn at random edge
+        Vector2 position;
+        switch (static_cast<int>(u[2] * 4)) {
+        case 0:
+            position = { u[3] * screenW, -r };
+            break;
+        case 1:
+            position = { screenW + r, u[3] * screenH };
+            break;
+        case 2:
+            position = { u[3] * screenW, screenH + r };
+            break;
+        default:
+            position = { -r, u[3] * screenH };
+            break;
+        }
+
+        // Aim towards center with jitter
+        float maxOff = fminf(screenW, screenH) * 0.1f;
+        float ang = u[4] * 2 * PI;
+        float rad = u[5] * maxOff;
+        Vector2 center = {
+                                         screenW * 0.5f + cosf(ang) * rad,
+                                         screenH * 0.5f + sinf(ang) * rad
+        };
+
+        Vector2 dir = Vector2Normalize(Vector2Subtract(center, position));
+        Vector2 velocity = Vector2Scale(dir, Lerp(SPEED_MIN, SPEED_MAX, u[6]) * speedMultiplier);
+
+        posX[i] = position.x;
+        posY[i] = position.y;
+        velX[i] = velocity.x;
+        velY[i] = velocity.y;
+        rotationSpeed[i] = Lerp(ROT_MIN, ROT_MAX, u[7]);
+        rotation[i] = u[8] * 360;
+
+        prevX[i] = posX[i];
+        prevY[i] = posY[i];
+        prevRotation[i] = rotation[i];
+        return i;
+    }
+
+    std::vector<float>   waveDraws;
+    std::vector<uint8_t> deadMask;
+};
+
+// Read-only view of one asteroid slot. Shape-specific data comes from the
+// per-shape views below instead of a vtable.
+class Asteroid {
+public:
+    Asteroid(const AsteroidStore& store, size_t slot) : store(store), slot(slot) {}
+
+    Vector2 GetPosition() const {
+        return { store.posX[slot], store.posY[slot] };
+    }
+
+    float GetRotation() const {
+        return store.rotation[slot];
+    }
+
+    // Transform 'alpha' of the way from the previous tick to the current one.
+    Vector2 GetDrawPosition(float alpha) const {
+        return {
+            Lerp(store.prevX[slot], store.posX[slot], alpha),
+            Lerp(store.prevY[slot], store.posY[slot], alpha)
+        };
+    }
+
+    float GetDrawRotation(float alpha) const {
+        return Lerp(store.prevRotation[slot], store.rotation[slot], alpha);
+    }
+
+    float GetRadius() const {
+        return store.radius[slot];
+    }
+
+    int GetDamage() const;
+
+    int GetSize() const {
+        return store.size[slot];
+    }
+
+    int GetPoints() const;
+
+    Color GetColor() const;
+
+    AsteroidShape GetShape() const {
+        return static_cast<AsteroidShape>(store.shape[slot]);
+    }
+
+protected:
+    const AsteroidStore& store;
+    size_t slot;
+};
+
+class TriangleAsteroid : public Asteroid {
+public:
+    using Asteroid::Asteroid;
+    static constexpr int baseDamage = 5;
+    static constexpr int pointsValue = 15;
+    static constexpr Color color = ORANGE;
+
+    void Draw(float alpha) const {
+        Renderer::Instance().DrawPoly(GetDrawPosition(alpha), 3, GetRadius(), GetDrawRotation(alpha), color);
+    }
+};
+
+class SquareAsteroid : public Asteroid {
+public:
+    using Asteroid::Asteroid;
+    static constexpr int baseDamage = 10;
+    static constexpr int pointsValue = 25;
+    static constexpr Color color = RED;
+
+    void Draw(float alpha) const {
+        Renderer::Instance().DrawPoly(GetDrawPosition(alpha), 4, GetRadius(), GetDrawRotation(alpha), color);
+    }
+};
+
+class PentagonAsteroid : public Asteroid {
+public:
+    using Asteroid::Asteroid;
+    static constexpr int baseDamage = 15;
+    static constexpr int pointsValue = 40;
+    static constexpr Color color = BLUE;
+
+    void Draw(float alpha) const {
+        Renderer::Instance().DrawPoly(GetDrawPosition(alpha), 5, GetRadius(), GetDrawRotation(alpha), color);
+    }
+};
+
+class StarAsteroid : public Asteroid {
+public:
+    using Asteroid::Asteroid;
+    static constexpr int baseDamage = 20;
+    static constexpr int pointsValue = 60;
+    static constexpr Color color = PURPLE;
+
+    void Draw(float alpha) const {
+        float radius = GetRadius();
+        Renderer::Instance().Shapes().Star(GetDrawPosition(alpha), 6, radius, radius * 0.5f, GetDrawRotation(alpha), color);
+    }
+};
+
+inline int Asteroid::GetDamage() const {
+    int baseDamage = 0;
+    switch (GetShape()) {
+    case AsteroidShape::TRIANGLE: baseDamage = TriangleAsteroid::baseDamage; break;
+    case AsteroidShape::SQUARE:   baseDamage = SquareAsteroid::baseDamage; break;
+    case AsteroidShape::PENTAGON: baseDamage = PentagonAsteroid::baseDamage; break;
+    case AsteroidShape::STAR:     baseDamage = StarAsteroid::baseDamage; break;
+    default: break;
+    }
+    return baseDamage * GetSize();
+}
+
+inline Color Asteroid::GetColor() const {
+    switch (GetShape()) {
+    case AsteroidShape::TRIANGLE: return TriangleAsteroid::color;
+    case AsteroidShape::SQUARE:   return SquareAsteroid::color;
+    case AsteroidShape::PENTAGON: return PentagonAsteroid::color;
+    case AsteroidShape::STAR:     return StarAsteroid::color;
+    default:                      return WHITE;
+    }
+}
+
+inline int Asteroid::GetPoints() const {
+    int pointsValue = 10;
+    switch (GetShape()) {
+    case AsteroidShape::TRIANGLE: pointsValue = TriangleAsteroid::pointsValue; break;
+    case AsteroidShape::SQUARE:   pointsValue = SquareAsteroid::pointsValue; break;
+    case AsteroidShape::PENTAGON: pointsValue = PentagonAsteroid::pointsValue; break;
+    case AsteroidShape::STAR:     pointsValue = StarAsteroid::pointsValue; break;
+    default: break;
+    }
+    return pointsValue * GetSize();
+}
+
+inline void AsteroidStore::Draw(float alpha) const {
+    PROFILE_ZONE("Asteroids");
+    for (size_t i = 0; i < Size(); i++) {
+        switch (static_cast<AsteroidShape>(shape[i])) {
+        case AsteroidShape::TRIANGLE: TriangleAsteroid(*this, i).Draw(alpha); break;
+        case AsteroidShape::SQUARE:   SquareAsteroid(*this, i).Draw(alpha); break;
+        case AsteroidShape::PENTAGON: PentagonAsteroid(*this, i).Draw(alpha); break;
+        case AsteroidShape::STAR:     StarAsteroid(*this, i).Draw(alpha); break;
+        default: break;
+        }
+    }
+}
+
+// --- EXPLOSION EFFECT ---
+struct ExplosionColumns {
+    std::vector<float> posX, posY;
+    std::vector<float> radius, maxRadius;
+    std::vector<float> duration, timer;
+    std::vector<Color> color;
+
+    template <typename F>
+    void ForEachColumn(F&& f) {
+        f(posX); f(posY);
+        f(radius); f(maxRadius);
+        f(duration); f(timer);
+        f(color);
+    }
+};
+
+class ExplosionStore : public EntityStore<ExplosionColumns> {
+public:
+    size_t Spawn(Vector2 pos, float maxRad, float dur, Color col) {
+        size_t i = Add();
+        if (i == npos) return npos;
+        posX[i] = pos.x;
+        posY[i] = pos.y;
+        maxRadius[i] = maxRad;
+        duration[i] = dur;
+        color[i] = col;
+        return i;
+    }
+
+    void Update(float dt) {
+        Jobs::Scheduler::Instance().ParallelFor(Size(), Kernels::CHUNK, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                timer[i] += dt;
+                radius[i] = maxRadius[i] * (timer[i] / duration[i]);
+            }
+        });
+        for (size_t i = Size(); i-- > 0;) {
+            if (timer[i] >= duration[i]) RemoveAt(i);
+        }
+    }
+
+    void Draw() const {
+        PROFILE_ZONE("Explosions");
+        for (size_t i = 0; i < Size(); i++) {
+            float alpha = 1.0f - (timer[i] / duration[i]);
+            Color fadeColor = { color[i].r, color[i].g, color[i].b, static_cast<unsigned char>(alpha * 255) };
+            Renderer::Instance().Shapes().Ring({ posX[i], posY[i] }, radius[i], 1.f, fadeColor);
+        }
+    }
+};
+
+// --- PARTICLES ---
+// Fixed-budget struct-of-arrays particle storage for one blend mode. Particles
+// only move and fade; Update ages them and compacts the survivors in one
+// branch-free pass. When the budget is exhausted new particles overwrite old
+// ones in ring order instead of failing.
+class ParticlePool {
+public:
+    explicit ParticlePool(size_t budget, float drag)
+        : budget(budget), drag(drag)
+    {
+        posX.resize(budget); posY.resize(budget);
+        velX.resize(budget); velY.resize(budget);
+        age.resize(budget); life.resize(budget);
+        size.resize(budget); color.resize(budget);
+    }
+
+    void Emit(Vector2 pos, Vector2 vel, float lifetime, float sz, Color col) {
+        size_t i;
+        if (count < budget) {
+            i = count++;
+        }
+        else {
+            i = recycle;
+            recycle = (recycle + 1) % budget;
+        }
+        posX[i] = pos.x;
+        posY[i] = pos.y;
+        velX[i] = vel.x;
+        velY[i] = vel.y;
+        age[i] = 0.f;
+        life[i] = lifetime;
+        size[i] = sz;
+        color[i] = col;
+    }
+
+    // Every particle is copied down to the write cursor, which only advances
+    // past the ones still alive.
+    void Update(float dt) {
+        float damping = powf(drag, dt);
+        size_t w = 0;
+        for (size_t i = 0; i < count; i++) {
+            float a = age[i] + dt;
+            posX[w] = posX[i] + velX[i] * dt;
+            posY[w] = posY[i] + velY[i] * dt;
+            velX[w] = velX[i] * damping;
+            velY[w] = velY[i] * damping;
+            age[w] = a;
+            life[w] = life[i];
+            size[w] = size[i];
+            color[w] = color[i];
+            w += static_cast<size_t>(a < life[i]);
+        }
+        count = w;
+        recycle = std::min(recycle, count);
+    }
+
+    void Clear() {
+        count = 0;
+        recycle = 0;
+    }
+
+    size_t Count() const {
+        return count;
+    }
+
+    size_t Budget() const {
+        return budget;
+    }
+
+    std::vector<float> posX, posY;
+    std::vector<float> velX, velY;
+    std::vector<float> age, life;
+    std::vector<float> size;
+    std::vector<Color> color;
+
+private:
+    size_t budget;
+    float drag;        // Fraction of velocity kept per second
+    size_t count = 0;
+    size_t recycle = 0;
+};
+
+// Game effects on top of two pools: alpha-blended debris and additive glow
+// (thrust and sparks, drawn with spark_flame.png). Each pool is one instanced
+// draw. Purely cosmetic: draws from the EFFECTS stream and is left out of the
+// world checksum.
+class ParticleSystem {
+public:
+    static constexpr const char* SPARK_PATH = "../resources/spark_flame.png";
+
+    ParticleSystem()
+        : debris(POOL_BUDGET, 0.2f)
+        , glow(POOL_BUDGET, 0.05f)
+    {
+        instances.reserve(POOL_BUDGET);
+    }
+
+    void Load() {
+        if (!IsWindowReady()) return;
+        spark = SpriteAtlas::Instance().Find(SPARK_PATH);
+        if (!spark.Valid()) {
+            sparkHandle = AssetCache::Instance().AcquireTexture(SPARK_PATH);
+            if (sparkHandle.Valid()) {
+                const Texture2D& texture = AssetCache::Instance().Get(sparkHandle);
+                spark = { texture, { 0, 0, static_cast<float>(texture.width), static_cast<float>(texture.height) } };
+            }
+        }
+        if (rlGetVersion() < RL_OPENGL_33) return;
+        shader = rlLoadShaderCode(VERTEX_SHADER, FRAGMENT_SHADER);
+        if (shader == rlGetShaderIdDefault()) {
+            shader = 0;
+            return;
+        }
+        mvpLoc = rlGetLocationUniform(shader, "mvp");
+        texturedLoc = rlGetLocationUniform(shader, "textured");
+        spriteLoc = rlGetLocationUniform(shader, "sprite");
+
+        static constexpr float corners[] = { -1, -1,  1, -1,  1, 1,  -1, -1,  1, 1,  -1, 1 };
+        vao = rlLoadVertexArray();
+        rlEnableVertexArray(vao);
+        quadVbo = rlLoadVertexBuffer(corners, sizeof(corners), false);
+        SetAttribute("vertexPosition", 2, RL_FLOAT, false, 0, 0, 0);
+        instanceVbo = rlLoadVertexBuffer(nullptr, static_cast<int>(POOL_BUDGET * sizeof(ParticleInstance)), true);
+        SetAttribute("instanceSprite", 3, RL_FLOAT, false, sizeof(ParticleInstance), offsetof(ParticleInstance, x), 1);
+        SetAttribute("instanceColor", 4, RL_UNSIGNED_BYTE, true, sizeof(ParticleInstance), offsetof(ParticleInstance, color), 1);
+        rlDisableVertexArray();
+    }
+
+    void Unload() {
+        AssetCache::Instance().Release(sparkHandle);
+        spark = {};
+        if (shader == 0) return;
+        rlUnloadVertexArray(vao);
+        rlUnloadVertexBuffer(quadVbo);
+        rlUnloadVertexBuffer(instanceVbo);
+        rlUnloadShaderProgram(shader);
+        shader = 0;
+    }
+
+    // Fragments of a destroyed asteroid, more for bigger ones.
+    void Debris(Vector2 pos, int asteroidSize, Color col) {
+        RandomStream& rng = Random::Instance().Stream(RandomStreamId::EFFECTS);
+        int n = 10 * asteroidSize;
+        for (int i = 0; i < n; i++) {
+            float angle = rng.NextFloat(0.f, 2.f * PI);
+            float speed = rng.NextFloat(40.f, 90.f) * sqrtf(static_cast<float>(asteroidSize));
+            debris.Emit(pos, { cosf(angle) * speed, sinf(angle) * speed },
+                rng.NextFloat(0.4f, 0.9f), rng.NextFloat(1.5f, 3.f), col);
+        }
+    }
+
+    // Short bright streaks where a projectile hits.
+    void Sparks(Vector2 pos) {
+        RandomStream& rng = Random::Instance().Stream(RandomStreamId::EFFECTS);
+        for (int i = 0; i < 8; i++) {
+            float angle = rng.NextFloat(0.f, 2.f * PI);
+            float speed = rng.NextFloat(150.f, 400.f);
+            glow.Emit(pos, { cosf(angle) * speed, sinf(angle) * speed },
+                rng.NextFloat(0.15f, 0.35f), rng.NextFloat(5.f, 9.f), { 255, 200, 80, 255 });
+        }
+    }
+
+    // Exhaust leaving 'pos' in direction 'dir' (unit length).
+    void Thrust(Vector2 pos, Vector2 dir) {
+        RandomStream& rng = Random::Instance().Stream(RandomStreamId::EFFECTS);
+        for (int i = 0; i < 2; i++) {
+            float speed = rng.NextFloat(120.f, 220.f);
+            Vector2 vel = { dir.x * speed + rng.NextFloat(-30.f, 30.f), dir.y * speed + rng.NextFloat(-30.f, 30.f) };
+            glow.Emit(pos, vel, rng.NextFloat(0.2f, 0.4f), rng.NextFloat(6.f, 10.f), { 255, 140, 40, 255 });
+        }
+    }
+
+    // Ring of glow expanding from 'center'.
+    void Burst(Vector2 center, int n, float speed, Color col) {
+        RandomStream& rng = Random::Instance().Stream(RandomStreamId::EFFECTS);
+        for (int i = 0; i < n; i++) {
+            float angle = rng.NextFloat(0.f, 2.f * PI);
+            float s = speed * rng.NextFloat(0.7f, 1.f);
+            glow.Emit(center, { cosf(angle) * s, sinf(angle) * s }, rng.NextFloat(0.6f, 1.f), rng.NextFloat(8.f, 14.f), col);
+        }
+    }
+
+    void Update(float dt) {
+        debris.Update(dt);
+        glow.Update(dt);
+        tickDt = dt;
+    }
+
+    void Clear() {
+        debris.Clear();
+        glow.Clear();
+    }
+
+    size_t Count() const {
+        return debris.Count() + glow.Count();
+    }
+
+    // One draw per pool; positions are extrapolated back to 'alpha' of the last tick.
+    void Draw(float alpha) {
+        PROFILE_ZONE("Particles");
+        Renderer::Instance().Shapes().Flush();
+        DrawPool(debris, alpha, false);
+        DrawPool(glow, alpha, true);
+    }
+
+private:
+    struct ParticleInstance {
+        float x, y, size;
+        Color color;
+    };
+
+    void DrawPool(const ParticlePool& pool, float alpha, bool additive) {
+        if (pool.Count() == 0) return;
+        float back = (alpha - 1.f) * tickDt;
+        bool textured = additive && spark.Valid();
+
+        instances.clear();
+        for (size_t i = 0; i < pool.Count(); i++) {
+            float t = pool.age[i] / pool.life[i];
+            Color c = pool.color[i];
+            c.a = static_cast<unsigned char>(c.a * (1.f - t));
+            instances.push_back({ pool.posX[i] + pool.velX[i] * back, pool.posY[i] + pool.velY[i] * back,
+                                  pool.size[i] * (1.f - 0.5f * t), c });
+        }
+
+        rlSetBlendMode(additive ? RL_BLEND_ADDITIVE : RL_BLEND_ALPHA);
+        if (shader != 0) {
+            rlEnableShader(shader);
+            rlSetUniformMatrix(mvpLoc, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+            int useTexture = textured ? 1 : 0;
+            rlSetUniform(texturedLoc, &useTexture, RL_SHADER_UNIFORM_INT, 1);
+            if (textured) {
+                // Offset and size of the spark in texture coordinates
+                float w = static_cast<float>(spark.texture.width), h = static_cast<float>(spark.texture.height);
+                float sprite[4] = { spark.source.x / w, spark.source.y / h, spark.source.width / w, spark.source.height / h };
+                rlSetUniform(spriteLoc, sprite, RL_SHADER_UNIFORM_VEC4, 1);
+                rlEnableTexture(spark.texture.id);
+            }
+            rlEnableVertexArray(vao);
+            rlUpdateVertexBuffer(instanceVbo, instances.data(), static_cast<int>(instances.size() * sizeof(ParticleInstance)), 0);
+            rlDisableBackfaceCulling();
+            rlDrawVertexArrayInstanced(0, 6, static_cast<int>(instances.size()));
+            rlEnableBackfaceCulling();
+            rlDisableVertexArray();
+            rlDisableTexture();
+            rlDisableShader();
+        }
+        else {
+            for (const ParticleInstance& p : instances) {
+                if (textured) {
+                    DrawTexturePro(spark.texture, spark.source,
+                        { p.x - p.size, p.y - p.size, p.size * 2.f, p.size * 2.f }, {}, 0.f, p.color);
+                }
+                else {
+                    DrawCircleV({ p.x, p.y }, p.size, p.color);
+                }
+            }
+            rlDrawRenderBatchActive();
+        }
+        rlSetBlendMode(RL_BLEND_ALPHA);
+    }
+
+    void SetAttribute(const char* name, int components, int type, bool normalized, int stride, size_t offset, int divisor) {
+        int loc = rlGetLocationAttrib(shader, name);
+        if (loc < 0) return;
+        rlSetVertexAttribute(loc, components, type, normalized, stride, reinterpret_cast<const void*>(offset));
+        rlSetVertexAttributeDivisor(loc, divisor);
+        rlEnableVertexAttribute(loc);
+    }
+
+    static constexpr size_t POOL_BUDGET = 65'536;
+
+    static constexpr const char* VERTEX_SHADER = R"(#version 330
+in vec2 vertexPosition;
+in vec3 instanceSprite;
+in vec4 instanceColor;
+uniform mat4 mvp;
+out vec2 uv;
+flat out vec4 color;
+void main() {
+    uv = vertexPosition;
+    color = instanceColor;
+    gl_Position = mvp * vec4(instanceSprite.xy + vertexPosition * instanceSprite.z, 0.0, 1.0);
+}
+)";
+
+    static constexpr const char* FRAGMENT_SHADER = R"(#version 330
+in vec2 uv;
+flat in vec4 color;
+uniform sampler2D texture0;
+uniform int textured;
+uniform vec4 sprite;
+out vec4 finalColor;
+void main() {
+    if (textured != 0) {
+        finalColor = texture(texture0, sprite.xy + (uv * 0.5 + 0.5) * sprite.zw) * color;
+    }
+    else {
+        float edge = 1.0 - smoothstep(0.6, 1.0, length(uv));
+        finalColor = vec4(color.rgb, color.a * edge);
+    }
+}
+)";
+
+    ParticlePool debris;
+    ParticlePool glow;
+    std::vector<ParticleInstance> instances;
+    float tickDt = 0.f;
+
+    TextureHandle sparkHandle;  // Only without the atlas
+    Sprite spark;
+    unsigned int shader = 0;
+    int mvpLoc = -1;
+    int texturedLoc = -1;
+    int spriteLoc = -1;
+    unsigned int vao = 0;
+    unsigned int quadVbo = 0;
+    unsigned int instanceVbo = 0;
+};
+
+// --- PROJECTILES ---
+enum class WeaponType { LASER, BULLET, COUNT };
+
+struct ProjectileColumns {
+    std::vector<float>   posX, posY;
+    std::vector<float>   prevX, prevY;  // position at the start of the tick
+    std::vector<float>   velX, velY;
+    std::vector<int>     damage;
+    std::vector<uint8_t> type;  // WeaponType
+
+    template <typename F>
+    void ForEachColumn(F&& f) {
+        f(posX); f(posY);
+        f(prevX); f(prevY);
+        f(velX); f(velY);
+        f(damage);
+        f(type);
+    }
+};
+
+class ProjectileStore : public EntityStore<ProjectileColumns> {
+public:
+    size_t Spawn(WeaponType wt, const Vector2 pos, float speed) {
+        size_t i = Add();
+        if (i == npos) return npos;
+        posX[i] = pos.x;
+        posY[i] = pos.y;
+        velX[i] = 0.f;
+        velY[i] = -speed;
+        damage[i] = (wt == WeaponType::LASER) ? 20 : 10;
+        type[i] = static_cast<uint8_t>(wt);
+
+        // Spawned mid-tick: no previous state to interpolate from
+        prevX[i] = pos.x;
+        prevY[i] = pos.y;
+        return i;
+    }
+
+    void SetCapacity(size_t n) {
+        EntityStore::SetCapacity(n);
+        deadMask.reserve((n + 7) / 8);
+    }
+
+    void SavePrevious() {
+        prevX = posX;
+        prevY = posY;
+    }
+
+    // Moves every projectile and removes the ones that left the screen.
+    void Update(float dt, float screenW, float screenH) {
+        deadMask.resize((Size() + 7) / 8);
+        std::atomic<size_t> dead{ 0 };
+        Jobs::Scheduler::Instance().ParallelFor(Size(), Kernels::CHUNK, [&](size_t begin, size_t end) {
+            size_t n = end - begin;
+            Kernels::Integrate(&posX[begin], &velX[begin], n, dt);
+            Kernels::Integrate(&posY[begin], &velY[begin], n, dt);
+            dead += Kernels::CullOutside(&posX[begin], &posY[begin], nullptr, n,
+                0.f, 0.f, screenW, screenH, &deadMask[begin / 8]);
+        });
+        if (dead) {
+            RemoveMasked(deadMask.data());
+        }
+    }
+
+    void Draw(float alpha) const;
+
+    static float RadiusOf(WeaponType wt) {
+        return (wt == WeaponType::BULLET) ? 6.f : 3.f;
+    }
+
+private:
+    std::vector<uint8_t> deadMask;
+};
+
+// Read-only view of one projectile slot.
+class Projectile {
+public:
+    Projectile(const ProjectileStore& store, size_t slot) : store(store), slot(slot) {}
+
+    void Draw(float alpha) const {
+        Vector2 position = {
+            Lerp(store.prevX[slot], store.posX[slot], alpha),
+            Lerp(store.prevY[slot], store.posY[slot], alpha)
+        };
+        ShapeBatch& shapes = Renderer::Instance().Shapes();
+        if (GetType() == WeaponType::BULLET) {
+            shapes.Circle(position, 6.f, ORANGE);
+            shapes.Circle(position, 3.f, WHITE);
+        }
+        else {
+            static constexpr float LASER_LENGTH = 40.f;
+            static constexpr float LASER_WIDTH = 6.f;
+
+            // Body, core and centre line, each a capsule that stays inside the body
+            auto beam = [&](float from, float to, float width, Color color) {
+                float r = width * 0.5f;
+                shapes.Capsule({ position.x, position.y - LASER_LENGTH * from - r },
+                               { position.x, position.y - LASER_LENGTH * to + r }, r, color);
+            };
+            beam(0.f, 1.f, LASER_WIDTH, BLUE);
+            beam(0.1f, 0.9f, LASER_WIDTH * 0.5f, SKYBLUE);
+            beam(0.f, 0.85f, 1.5f, WHITE);
+        }
+    }
+
+    Vector2 GetPosition() const {
+        return { store.posX[slot], store.posY[slot] };
+    }
+
+    float GetRadius() const {
+        return ProjectileStore::RadiusOf(GetType());
+    }
+
+    int GetDamage() const {
+        return store.damage[slot];
+    }
+
+    WeaponType GetType() const {
+        return static_cast<WeaponType>(store.type[slot]);
+    }
+
+private:
+    const ProjectileStore& store;
+    size_t slot;
+};
+
+inline void ProjectileStore::Draw(float alpha) const {
+    PROFILE_ZONE("Projectiles");
+    for (size_t i = 0; i < Size(); i++) {
+        Projectile(*this, i).Draw(alpha);
+    }
+}
+
+// --- SHIP HIERARCHY ---
+class Ship {
+public:
+    Ship(int screenW, int screenH) {
+        transform.position = {
+                                         screenW * 0.5f,
+                                         screenH * 0.5f
+        };
+        hp = 100;
+        maxHp = 100;
+        speed = 250.f;
+        alive = true;
+
+        fireRateLaser = 18.f;
+        fireRateBullet = 22.f;
+        spacingLaser = 40.f;
+        spacingBullet = 20.f;
+
+        previous = transform;
+    }
+    virtual ~Ship() = default;
+    virtual void Update(float dt, const InputState& input) = 0;
+    virtual void Draw(float alpha) const = 0;
+
+    void SavePrevious() {
+        previous = transform;
+    }
+
+    void TakeDamage(int dmg) {
+        if (!alive || invulnerable) return;
+        hp -= dmg;
+        if (hp <= 0) alive = false;
+    }
+
+    void Heal(int amount) {
+        hp = std::min(hp + amount, maxHp);
+    }
+
+    void UpgradeWeapon(WeaponType wt) {
+        if (wt == WeaponType::LASER) {
+            fireRateLaser *= 1.2f;
+            spacingLaser *= 1.1f;
+        }
+        else {
+            fireRateBullet *= 1.2f;
+            spacingBullet *= 1.1f;
+        }
+    }
+
+    bool IsAlive() const {
+        return alive;
+    }
+
+    // Benchmark scenarios keep the ship alive so the workload stays constant.
+    void SetInvulnerable(bool value) {
+        invulnerable = value;
+    }
+
+    Vector2 GetPosition() const {
+        return transform.position;
+    }
+
+    virtual float GetRadius() const = 0;
+
+    int GetHP() const {
+        return hp;
+    }
+
+    int GetMaxHP() const {
+        return maxHp;
+    }
+
+    float GetFireRate(WeaponType wt) const {
+        return (wt == WeaponType::LASER) ? fireRateLaser : fireRateBullet;
+    }
+
+    float GetSpacing(WeaponType wt) const {
+        return (wt == WeaponType::LASER) ? spacingLaser : spacingBullet;
     }
-}
-
-// --- TRANSFORM, PHYSICS, LIFETIME, RENDERABLE ---
-struct TransformA {
-    Vector2 position{};
-    float rotation{};
-};
 
-struct Physics {
-    Vector2 velocity{};
-    float rotationSpeed{};
-};
+protected:
+    Vector2 GetDrawPosition(float alpha) const {
+        return Vector2Lerp(previous.position, transform.position, alpha);
+    }
 
-struct Renderable {
-    enum Size { SMALL = 1, MEDIUM = 2, LARGE = 4 } size = SMALL;
+    TransformA transform;
+    TransformA previous;
+    int        hp;
+    int        maxHp;
+    float      speed;
+    bool       alive;
+    bool       invulnerable = false;
+    float      fireRateLaser;
+    float      fireRateBullet;
+    float      spacingLaser;
+    float      spacingBullet;
 };
 
-// --- RENDERER ---
-class Renderer {
+class PlayerShip :public Ship {
 public:
-    static Renderer& Instance() {
-        static Renderer inst;
-        return inst;
-    }
+    static constexpr const char* TEXTURE_PATH = "spaceship1.png";
+    static constexpr int TEXTURE_FILTER = TEXTURE_FILTER_TRILINEAR;
 
-    void Init(int w, int h, const char* title) {
-        InitWindow(w, h, title);
-        SetTargetFPS(60);
-        screenW = w;
-        screenH = h;
+    PlayerShip(int w, int h) : Ship(w, h) {
+        sprite = SpriteAtlas::Instance().Find(TEXTURE_PATH);
+        if (!sprite.Valid()) textureHandle = AssetCache::Instance().AcquireTexture(TEXTURE_PATH, true, TEXTURE_FILTER);
+        if (textureHandle.Valid()) {
+            const Texture2D& texture = AssetCache::Instance().Get(textureHandle);
+            sprite = { texture, { 0, 0, static_cast<float>(texture.width), static_cast<float>(texture.height) } };
+        }
+        else if (!sprite.Valid()) {
+            // Headless: nothing to upload to, but collisions still need the sprite size
+            sprite.source = { 0, 0, TEXTURE_WIDTH, TEXTURE_HEIGHT };
+        }
+        scale = 0.25f;
     }
-
-    void Begin() {
-        BeginDrawing();
-        ClearBackground(BLACK);
+    ~PlayerShip() {
+        AssetCache::Instance().Release(textureHandle);
     }
 
-    void End() {
-        EndDrawing();
-    }
+    PlayerShip(const PlayerShip&) = delete;
+    PlayerShip& operator=(const PlayerShip&) = delete;
 
-    void DrawPoly(const Vector2& pos, int sides, float radius, float rot, Color color = WHITE) {
-        DrawPolyLines(pos, sides, radius, rot, color);
+    void Update(float dt, const InputState& input) override {
+        if (alive) {
+            if (input.Down(BTN_UP)) transform.position.y -= speed * dt;
+            if (input.Down(BTN_DOWN)) transform.position.y += speed * dt;
+            if (input.Down(BTN_LEFT)) transform.position.x -= speed * dt;
+            if (input.Down(BTN_RIGHT)) transform.position.x += speed * dt;
+
+            // Keep ship within bounds
+            transform.position.x = std::clamp(transform.position.x, GetRadius(), Renderer::Instance().Width() - GetRadius());
+            transform.position.y = std::clamp(transform.position.y, GetRadius(), Renderer::Instance().Height() - GetRadius());
+        }
+        else {
+            transform.position.y += speed * dt;
+        }
     }
 
-    int Width() const {
-        return screenW;
+    void Draw(float alpha) const override {
+        PROFILE_ZONE("Player");
+        if (!alive && fmodf(GetTime(), 0.4f) > 0.2f) return;
+        Vector2 position = GetDrawPosition(alpha);
+        Rectangle dst = {
+                                         position.x - (sprite.source.width * scale) * 0.5f,
+                                         position.y - (sprite.source.height * scale) * 0.5f,
+                                         sprite.source.width * scale,
+                                         sprite.source.height * scale
+        };
+        DrawTexturePro(sprite.texture, sprite.source, dst, {}, 0.0f, WHITE);
+
+        // Draw health bar
+        if (alive) {
+            float healthPercentage = static_cast<float>(hp) / maxHp;
+            Rectangle backBar = { position.x - 50, position.y - GetRadius() - 20, 100, 10 };
+            Rectangle healthBar = { backBar.x, backBar.y, backBar.width * healthPercentage, backBar.height };
+            
+            DrawRectangleRec(backBar, RED);
+            DrawRectangleRec(healthBar, GREEN);
+            DrawRectangleLinesEx(backBar, 2, DARKGRAY);
+        }
     }
 
-    int Height() const {
-        return screenH;
+    float GetRadius() const override {
+        return (sprite.source.width * scale) * 0.5f;
     }
 
 private:
-    Renderer() = default;
+    static constexpr int TEXTURE_WIDTH = 900;   // spaceship1.png
+    static constexpr int TEXTURE_HEIGHT = 587;
 
-    int screenW{};
-    int screenH{};
+    TextureHandle textureHandle;  // Only without the atlas
+    Sprite        sprite;
+    float         scale;
 };
 
-// --- ASTEROID HIERARCHY ---
-class Asteroid {
-public:
-    Asteroid(int screenW, int screenH) {
-        init(screenW, screenH);
-    }
-    virtual ~Asteroid() = default;
+// --- POWERUP ---
+enum class PowerUpType { HEALTH, WEAPON_UPGRADE };
 
-    bool Update(float dt) {
-        transform.position = Vector2Add(transform.position, Vector2Scale(physics.velocity, dt));
-        transform.rotation += physics.rotationSpeed * dt;
-        if (transform.position.x < -GetRadius() || transform.position.x > Renderer::Instance().Width() + GetRadius() ||
-            transform.position.y < -GetRadius() || transform.position.y > Renderer::Instance().Height() + GetRadius())
-            return false;
-        return true;
+struct PowerUpColumns {
+    std::vector<float>   posX, posY;
+    std::vector<float>   rotation, timer;
+    std::vector<uint8_t> type;  // PowerUpType
+
+    template <typename F>
+    void ForEachColumn(F&& f) {
+        f(posX); f(posY);
+        f(rotation); f(timer);
+        f(type);
     }
-    virtual void Draw() const = 0;
+};
 
-    Vector2 GetPosition() const {
-        return transform.position;
+class PowerUpStore : public EntityStore<PowerUpColumns> {
+public:
+    size_t Spawn(Vector2 pos, PowerUpType t) {
+        size_t i = Add();
+        if (i == npos) return npos;
+        posX[i] = pos.x;
+        posY[i] = pos.y;
+        type[i] = static_cast<uint8_t>(t);
+        return i;
     }
 
-    float GetRadius() const {
-        return 16.f * (float)render.size;
+    void Update(float dt) {
+        for (size_t i = 0; i < Size(); i++) {
+            rotation[i] += ROTATION_SPEED * dt;
+            timer[i] += dt;
+        }
+        for (size_t i = Size(); i-- > 0;) {
+            if (timer[i] >= LIFETIME) RemoveAt(i);
+        }
     }
 
-    int GetDamage() const {
-        return baseDamage * static_cast<int>(render.size);
+    void Draw() const {
+        PROFILE_ZONE("Power-ups");
+        ShapeBatch& shapes = Renderer::Instance().Shapes();
+        for (size_t i = 0; i < Size(); i++) {
+            Vector2 position = { posX[i], posY[i] };
+            bool health = static_cast<PowerUpType>(type[i]) == PowerUpType::HEALTH;
+            shapes.Circle(position, RADIUS, health ? GREEN : BLUE);
+            shapes.Circle(position, RADIUS * 0.6f, health ? LIME : SKYBLUE);
+        }
+
+        // Labels are queued with the rest of the frame's text, drawn last
+        for (size_t i = 0; i < Size(); i++) {
+            if (static_cast<PowerUpType>(type[i]) == PowerUpType::HEALTH) {
+                TextRenderer::Instance().Draw("+", static_cast<int>(posX[i]) - 10, static_cast<int>(posY[i]) - 10, 20, DARKGREEN);
+            }
+            else {
+                TextRenderer::Instance().Draw("W", static_cast<int>(posX[i]) - 10, static_cast<int>(posY[i]) - 10, 20, DARKBLUE);
+            }
+        }
     }
 
-    int GetSize() const {
-        return static_cast<int>(render.size);
+    static constexpr float RADIUS = 15.f;
+    static constexpr float ROTATION_SPEED = 90.f;
+    static constexpr float LIFETIME = 10.f;
+};
+
+// --- SPATIAL GRID (collision broadphase) ---
+// Uniform grid over the play field. Items are binned by their center, so a
+// circle query only visits the cells overlapped by (radius + largest item radius).
+// The grid is rebuilt every frame with a counting sort: O(n), no allocations
+// once the buffers have grown to the peak entity count.
+class SpatialGrid {
+public:
+    SpatialGrid(float width, float height, float margin, float cellSize)
+        : originX(-margin), originY(-margin), invCellSize(1.f / cellSize)
+    {
+        cols = static_cast<int>(ceilf((width + 2.f * margin) / cellSize));
+        rows = static_cast<int>(ceilf((height + 2.f * margin) / cellSize));
+        cellStart.resize(static_cast<size_t>(cols) * rows + 1);
+        cursor.reserve(cellStart.size());
     }
 
-    int GetPoints() const {
-        return pointsValue * static_cast<int>(render.size);
+    void Reserve(size_t n) {
+        pendingId.reserve(n);
+        pendingCell.reserve(n);
+        items.reserve(n);
     }
 
-    Physics GetPhysics() const {
-        return physics;
+    void Clear() {
+        pendingId.clear();
+        pendingCell.clear();
+        maxItemRadius = 0.f;
     }
 
-    void SetPhysics(const Physics& phys) {
-        physics = phys;
+    void Insert(int id, Vector2 pos, float radius) {
+        pendingId.push_back(id);
+        pendingCell.push_back(CellIndex(CellX(pos.x), CellY(pos.y)));
+        maxItemRadius = std::max(maxItemRadius, radius);
     }
 
-protected:
-    void init(int screenW, int screenH) {
-        // Choose size
-        render.size = static_cast<Renderable::Size>(1 << GetRandomValue(0, 2));
+    // Sorts the inserted items into per-cell ranges of 'items'.
+    void Build() {
+        std::fill(cellStart.begin(), cellStart.end(), 0);
+        for (int cell : pendingCell) {
+            cellStart[cell + 1]++;
+        }
+        for (size_t c = 1; c < cellStart.size(); c++) {
+            cellStart[c] += cellStart[c - 1];
+        }
+        items.resize(pendingId.size());
+        cursor.assign(cellStart.begin(), cellStart.end() - 1);
+        for (size_t i = 0; i < pendingId.size(); i++) {
+            items[cursor[pendingCell[i]]++] = pendingId[i];
+        }
+    }
 
-        // Spawn at random edge
-        switch (GetRandomValue(0, 3)) {
-        case 0:
-            transform.position = { Utils::RandomFloat(0, screenW), -GetRadius() };
-            break;
-        case 1:
-            transform.position = { screenW + GetRadius(), Utils::RandomFloat(0, screenH) };
-            break;
-        case 2:
-            transform.position = { Utils::RandomFloat(0, screenW), screenH + GetRadius() };
-            break;
-        default:
-            transform.position = { -GetRadius(), Utils::RandomFloat(0, screenH) };
-            break;
+    // Calls fn(id) for every item whose cell may contain a circle overlapping
+    // (pos, radius). Returning true from fn stops the query early.
+    // Returns the number of candidates visited.
+    template <typename F>
+    int Query(Vector2 pos, float radius, F&& fn) const {
+        float reach = radius + maxItemRadius;
+        int x0 = CellX(pos.x - reach), x1 = CellX(pos.x + reach);
+        int y0 = CellY(pos.y - reach), y1 = CellY(pos.y + reach);
+        int visited = 0;
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                int cell = CellIndex(x, y);
+                for (int i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+                    visited++;
+                    if (fn(items[i])) return visited;
+                }
+            }
         }
+        return visited;
+    }
 
-        // Aim towards center with jitter
-        float maxOff = fminf(screenW, screenH) * 0.1f;
-        float ang = Utils::RandomFloat(0, 2 * PI);
-        float rad = Utils::RandomFloat(0, maxOff);
-        Vector2 center = {
-                                         screenW * 0.5f + cosf(ang) * rad,
-                                         screenH * 0.5f + sinf(ang) * rad
-        };
+private:
+    int CellX(float x) const {
+        return std::clamp(static_cast<int>((x - originX) * invCellSize), 0, cols - 1);
+    }
 
-        Vector2 dir = Vector2Normalize(Vector2Subtract(center, transform.position));
-        physics.velocity = Vector2Scale(dir, Utils::RandomFloat(SPEED_MIN, SPEED_MAX));
-        physics.rotationSpeed = Utils::RandomFloat(ROT_MIN, ROT_MAX);
+    int CellY(float y) const {
+        return std::clamp(static_cast<int>((y - originY) * invCellSize), 0, rows - 1);
+    }
 
-        transform.rotation = Utils::RandomFloat(0, 360);
+    int CellIndex(int x, int y) const {
+        return y * cols + x;
     }
 
-    TransformA transform;
-    Physics    physics;
-    Renderable render;
+    float originX;
+    float originY;
+    float invCellSize;
+    float maxItemRadius = 0.f;
+    int   cols;
+    int   rows;
 
-    int baseDamage = 0;
-    int pointsValue = 10;
-    static constexpr float SPEED_MIN = 125.f;
-    static constexpr float SPEED_MAX = 250.f;
-    static constexpr float ROT_MIN = 50.f;
-    static constexpr float ROT_MAX = 240.f;
+    std::vector<int> cellStart;
+    std::vector<int> cursor;
+    std::vector<int> items;
+    std::vector<int> pendingId;
+    std::vector<int> pendingCell;
 };
 
-class TriangleAsteroid : public Asteroid {
-public:
-    TriangleAsteroid(int w, int h) : Asteroid(w, h) { 
-        baseDamage = 5; 
-        pointsValue = 15;
-    }
-    void Draw() const override {
-        Renderer::Instance().DrawPoly(transform.position, 3, GetRadius(), transform.rotation, ORANGE);
-    }
+struct CollisionStats {
+    int candidatePairs = 0;
+    int hits = 0;
 };
 
-class SquareAsteroid : public Asteroid {
-public:
-    SquareAsteroid(int w, int h) : Asteroid(w, h) { 
-        baseDamage = 10; 
-        pointsValue = 25;
-    }
-    void Draw() const override {
-        Renderer::Instance().DrawPoly(transform.position, 4, GetRadius(), transform.rotation, RED);
-    }
-};
+// --- BENCHMARK ---
+enum class BenchScenario { MIXED, ASTEROIDS, FIRE, EXPLOSIONS, PARTICLES };
 
-class PentagonAsteroid : public Asteroid {
-public:
-    PentagonAsteroid(int w, int h) : Asteroid(w, h) { 
-        baseDamage = 15; 
-        pointsValue = 40;
-    }
-    void Draw() const override {
-        Renderer::Instance().DrawPoly(transform.position, 5, GetRadius(), transform.rotation, BLUE);
-    }
+struct BenchOptions {
+    BenchScenario scenario = BenchScenario::MIXED;
+    int  ticks = 10'000;
+    int  warmupTicks = 600;
+    bool render = false;  // Draw every tick into a window instead of null rendering
+    bool audio = false;   // Mix the sound effects; ticks then run in real time
 };
 
-class StarAsteroid : public Asteroid {
-public:
-    StarAsteroid(int w, int h) : Asteroid(w, h) { 
-        baseDamage = 20; 
-        pointsValue = 60;
-    }
-    void Draw() const override {
-        float radius = GetRadius();
-        Vector2 center = transform.position;
-        float rotation = transform.rotation;
-        
-        Vector2 points[12];
-        float angleStep = PI / 3.0f;
-        
-        for (int i = 0; i < 6; i++) {
-            float angle = angleStep * i + rotation * DEG2RAD;
-            points[i*2] = {
-                center.x + cosf(angle) * radius,
-                center.y + sinf(angle) * radius
-            };
-            
-            angle = angleStep * (i + 0.5f) + rotation * DEG2RAD;
-            points[i*2 + 1] = {
-                center.x + cosf(angle) * (radius * 0.5f),
-                center.y + sinf(angle) * (radius * 0.5f)
-            };
-        }
-        
-        for (int i = 0; i < 11; i++) {
-            DrawLineV(points[i], points[i+1], PURPLE);
+static inline bool ParseBenchScenario(const char* name, BenchScenario& out) {
+    static constexpr struct { const char* name; BenchScenario scenario; } names[] = {
+        { "mixed", BenchScenario::MIXED },
+        { "asteroids", BenchScenario::ASTEROIDS },
+        { "fire", BenchScenario::FIRE },
+        { "explosions", BenchScenario::EXPLOSIONS },
+        { "particles", BenchScenario::PARTICLES },
+    };
+    for (const auto& n : names) {
+        if (strcmp(name, n.name) == 0) {
+            out = n.scenario;
+            return true;
         }
-        DrawLineV(points[11], points[0], PURPLE);
     }
-};
-
-// Shape selector
-enum class AsteroidShape { TRIANGLE = 3, SQUARE = 4, PENTAGON = 5, STAR = 6, RANDOM = 0 };
+    return false;
+}
 
-// Factory
-static inline std::unique_ptr<Asteroid> MakeAsteroid(int w, int h, AsteroidShape shape) {
-    switch (shape) {
-    case AsteroidShape::TRIANGLE:
-        return std::make_unique<TriangleAsteroid>(w, h);
-    case AsteroidShape::SQUARE:
-        return std::make_unique<SquareAsteroid>(w, h);
-    case AsteroidShape::PENTAGON:
-        return std::make_unique<PentagonAsteroid>(w, h);
-    case AsteroidShape::STAR:
-        return std::make_unique<StarAsteroid>(w, h);
-    default: {
-        return MakeAsteroid(w, h, static_cast<AsteroidShape>(3 + GetRandomValue(0, 3)));
-    }
+static inline const char* BenchScenarioName(BenchScenario scenario) {
+    switch (scenario) {
+    case BenchScenario::ASTEROIDS:  return "asteroids";
+    case BenchScenario::FIRE:       return "fire";
+    case BenchScenario::EXPLOSIONS: return "explosions";
+    case BenchScenario::PARTICLES:  return "particles";
+    default:                        return "mixed";
     }
 }
 
-// --- EXPLOSION EFFECT ---
-struct Explosion {
-    Vector2 position;
-    float radius;
-    float maxRadius;
-    float duration;
-    float timer;
-    Color color;
-
-    Explosion(Vector2 pos, float maxRad, float dur, Color col) 
-        : position(pos), radius(0), maxRadius(maxRad), duration(dur), timer(0), color(col) {}
+// Average and max of a per-tick counter.
+struct BenchCounter {
+    uint64_t total = 0;
+    uint64_t max = 0;
 
-    bool Update(float dt) {
-        timer += dt;
-        radius = maxRadius * (timer / duration);
-        return timer >= duration;
+    void Add(uint64_t value) {
+        total += value;
+        max = std::max(max, value);
     }
 
-    void Draw() const {
-        float alpha = 1.0f - (timer / duration);
-        Color fadeColor = { color.r, color.g, color.b, static_cast<unsigned char>(alpha * 255) };
-        DrawCircleLines(position.x, position.y, radius, fadeColor);
+    double Average(int samples) const {
+        return samples > 0 ? static_cast<double>(total) / samples : 0.0;
     }
 };
 
-// --- PROJECTILE HIERARCHY ---
-enum class WeaponType { LASER, BULLET, COUNT };
-class Projectile {
+// Prints p50/p99/max/mean of per-tick timings (reorders 'tickNs').
+static inline void PrintTickTimes(std::vector<int64_t>& tickNs) {
+    auto percentile = [&tickNs](double q) {
+        size_t k = std::min(tickNs.size() - 1, static_cast<size_t>(q * tickNs.size()));
+        std::nth_element(tickNs.begin(), tickNs.begin() + k, tickNs.end());
+        return tickNs[k];
+    };
+    int64_t sum = 0;
+    for (int64_t ns : tickNs) sum += ns;
+
+    printf("tick ns      p50: %lld  p99: %lld  max: %lld  mean: %lld\n",
+        static_cast<long long>(percentile(0.50)), static_cast<long long>(percentile(0.99)),
+        static_cast<long long>(percentile(1.0)), static_cast<long long>(sum / static_cast<int64_t>(tickNs.size())));
+}
+
+// --- APPLICATION ---
+class Application {
 public:
-    Projectile(Vector2 pos, Vector2 vel, int dmg, WeaponType wt)
-    {
-        transform.position = pos;
-        physics.velocity = vel;
-        baseDamage = dmg;
-        type = wt;
-    }
-    bool Update(float dt) {
-        transform.position = Vector2Add(transform.position, Vector2Scale(physics.velocity, dt));
-
-        if (transform.position.x < 0 ||
-            transform.position.x > Renderer::Instance().Width() ||
-            transform.position.y < 0 ||
-            transform.position.y > Renderer::Instance().Height())
-        {
-            return true;
-        }
-        return false;
-    }
-    void Draw() const {
-        if (type == WeaponType::BULLET) {
-            DrawCircleV(transform.position, 6.f, ORANGE);
-            DrawCircleV(transform.position, 3.f, WHITE);
-        }
-        else {
-            static constexpr float LASER_LENGTH = 40.f;
-            static constexpr float LASER_WIDTH = 6.f;
-            
-            Rectangle lr = { 
-                transform.position.x - LASER_WIDTH * 0.5f, 
-                transform.position.y - LASER_LENGTH, 
-                LASER_WIDTH, 
-                LASER_LENGTH 
-            };
-            DrawRectangleRec(lr, BLUE);
-            
-            Rectangle innerLr = {
-                transform.position.x - LASER_WIDTH * 0.25f,
-                transform.position.y - LASER_LENGTH * 0.9f,
-                LASER_WIDTH * 0.5f,
-                LASER_LENGTH * 0.8f
-            };
-            DrawRectangleRec(innerLr, SKYBLUE);
-            
-            DrawLineEx(
-                {transform.position.x, transform.position.y},
-                {transform.position.x, transform.position.y - LASER_LENGTH * 0.85f},
-                1.5f, WHITE);
-        }
+    static Application& Instance() {
+        static Application inst;
+        return inst;
     }
-    Vector2 GetPosition() const {
-        return transform.position;
+
+    // Simulation rate in ticks per second, independent of the render rate.
+    void SetTickRate(int ticksPerSecond) {
+        tickRate = std::max(ticksPerSecond, 1);
     }
 
-    float GetRadius() const {
-        return (type == WeaponType::BULLET) ? 6.f : 3.f;
+    int GetTickRate() const {
+        return tickRate;
     }
 
-    int GetDamage() const {
-        return baseDamage;
+    static constexpr int ChecksumInterval() {
+        return C_CHECKSUM_INTERVAL;
     }
 
-private:
-    TransformA transform;
-    Physics    physics;
-    int        baseDamage;
-    WeaponType type;
-};
+    // Render pacing only; gameplay does not depend on it.
+    void SetRenderRate(int targetFps, bool vsync) {
+        renderFps = targetFps;
+        renderVsync = vsync;
+    }
 
-inline static Projectile MakeProjectile(WeaponType wt,
-    const Vector2 pos,
-    float speed)
-{
-    Vector2 vel{ 0, -speed };
-    if (wt == WeaponType::LASER) {
-        return Projectile(pos, vel, 20, wt);
+    // Cached or per-frame shaped HUD text (F3 in game).
+    void SetHudCached(bool cached) {
+        hudCached = cached;
     }
-    else {
-        return Projectile(pos, vel, 10, wt);
+
+    // Profiler capture written on exit; .csv for CSV, anything else for a Chrome trace.
+    void SetTracePath(const char* path) {
+        tracePath = path;
     }
-}
 
-// --- SHIP HIERARCHY ---
-class Ship {
-public:
-    Ship(int screenW, int screenH) {
-        transform.position = {
-                                         screenW * 0.5f,
-                                         screenH * 0.5f
-        };
-        hp = 100;
-        maxHp = 100;
-        speed = 250.f;
-        alive = true;
+    // Interactive loop. With a recorder every tick's input and periodic world
+    // checksums are captured; with a replay the recorded input drives the game
+    // instead of the keyboard and the checksums are verified.
+    void Run(InputRecorder* recorder = nullptr, InputReplay* replay = nullptr) {
+        Renderer::Instance().Init(C_WIDTH, C_HEIGHT, "Asteroids OOP", renderFps, renderVsync);
+        LoadGraphics();
+        LoadAudio();
 
-        fireRateLaser = 18.f;
-        fireRateBullet = 22.f;
-        spacingLaser = 40.f;
-        spacingBullet = 20.f;
+        Reset();
+
+        // Fixed-timestep loop: the simulation always advances in steps of tickDt,
+        // rendering interpolates between the last two simulated states.
+        const float tickDt = 1.f / tickRate;
+        float accumulator = 0.f;
+        InputState input;
+
+        while (!WindowShouldClose()) {
+            frameProfile.EndFrame();
+            PROFILE_ZONE("Frame");
+            accumulator += std::min(GetFrameTime(), C_MAX_FRAME_TIME);
+
+            {
+                PROFILE_ZONE("Input");
+                // Presses are latched until a tick consumes them, so none are lost
+                // on frames without a tick or repeated on frames with several.
+                if (!replay) {
+                    InputState frameInput = InputState::FromKeyboard();
+                    input.down = frameInput.down;
+                    input.pressed |= frameInput.pressed;
+                }
+
+                // Debug stats under the HUD
+                if (IsKeyPressed(KEY_F1)) {
+                    showDebugStats = !showDebugStats;
+                }
+
+                // SIMD/scalar kernel switch
+                if (IsKeyPressed(KEY_F2)) {
+                    Kernels::useSimd = !Kernels::useSimd;
+                }
+
+                // Cached/immediate HUD switch
+                if (IsKeyPressed(KEY_F3)) {
+                    hudCached = !hudCached;
+                }
+
+                // Profiler overlay and capture
+                if (IsKeyPressed(KEY_F4)) {
+                    showProfiler = !showProfiler;
+                }
+                if (IsKeyPressed(KEY_F5)) {
+                    SaveTrace(C_TRACE_JSON);
+                    SaveTrace(C_TRACE_CSV);
+                }
+            }
+
+            bool replayFinished = false;
+            while (accumulator >= tickDt) {
+                if (replay && !replay->Next(input)) {
+                    replayFinished = true;
+                    break;
+                }
+                if (recorder) recorder->Record(input);
+
+                Tick(tickDt, input);
+                input.pressed = 0;
+                accumulator -= tickDt;
+
+                if (recorder && tickCount % recorder->ChecksumInterval() == 0) {
+                    recorder->RecordChecksum(tickCount, WorldChecksum());
+                }
+                if (replay) replay->Verify(tickCount, WorldChecksum());
+            }
+            if (replayFinished) break;
+
+            // Only a store; decoding and the crossfade happen on the music thread
+            MusicStreamer::Instance().SetTrack(level - 1);
+
+            Draw(accumulator / tickDt);
+        }
+        UnloadAudio();
+        player.reset();  // Holds a texture; release it while the GL context is alive
+        UnloadGraphics();
+        Renderer::Instance().Close();
+        if (tracePath) SaveTrace(tracePath);
+
+        if (replay) PrintReplayResult(*replay);
     }
-    virtual ~Ship() = default;
-    virtual void Update(float dt) = 0;
-    virtual void Draw() const = 0;
 
-    void TakeDamage(int dmg) {
-        if (!alive) return;
-        hp -= dmg;
-        if (hp <= 0) alive = false;
+    // Re-runs a recording as fast as possible without a window and reports
+    // both the checksum verification and the time per tick.
+    int RunReplayHeadless(InputReplay& replay) {
+        SetTraceLogLevel(LOG_WARNING);
+        Renderer::Instance().InitHeadless(C_WIDTH, C_HEIGHT);
+        Reset();
+
+        const float tickDt = 1.f / tickRate;
+        std::vector<int64_t> tickNs;
+        tickNs.reserve(replay.TickCount());
+        auto runStart = std::chrono::steady_clock::now();
+
+        InputState input;
+        while (replay.Next(input)) {
+            auto start = std::chrono::steady_clock::now();
+            Tick(tickDt, input);
+            auto end = std::chrono::steady_clock::now();
+            tickNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+
+            replay.Verify(tickCount, WorldChecksum());
+        }
+
+        double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
+        printf("replay: %u ticks in %.2f ms (recorded at %d Hz = %.2f s of play)  kernels: %s\n",
+            tickCount, totalMs, tickRate, tickCount / static_cast<double>(tickRate),
+            Kernels::useSimd ? "SIMD" : "scalar");
+        if (!tickNs.empty()) PrintTickTimes(tickNs);
+        PrintReplayResult(replay);
+        return replay.Failed() == 0 ? 0 : 2;
     }
 
-    void Heal(int amount) {
-        hp = std::min(hp + amount, maxHp);
+    // Hash of everything the simulation depends on; equal checksums at equal
+    // ticks mean two runs produced the same game.
+    uint64_t WorldChecksum() const {
+        uint64_t h = ReplayFormat::FNV_OFFSET;
+        h = ReplayFormat::Hash(h, tickCount);
+        h = ReplayFormat::Hash(h, score);
+        h = ReplayFormat::Hash(h, level);
+        h = ReplayFormat::Hash(h, asteroidsDestroyed);
+        h = ReplayFormat::Hash(h, player->GetPosition());
+        h = ReplayFormat::Hash(h, player->GetHP());
+        h = asteroids.Checksum(h);
+        h = projectiles.Checksum(h);
+        h = explosions.Checksum(h);
+        h = powerups.Checksum(h);
+        return h;
     }
 
-    void UpgradeWeapon(WeaponType wt) {
-        if (wt == WeaponType::LASER) {
-            fireRateLaser *= 1.2f;
-            spacingLaser *= 1.1f;
+    // Runs the simulation for a fixed number of ticks with scripted input and
+    // prints tick-time percentiles, entity counts and allocations per tick.
+    // Needs no window unless options.render is set.
+    int RunBenchmark(const BenchOptions& options) {
+        SetTraceLogLevel(LOG_WARNING);
+        if (options.render) {
+            Renderer::Instance().Init(C_WIDTH, C_HEIGHT, "Asteroids OOP - benchmark", 0, false);
+            LoadGraphics();
         }
         else {
-            fireRateBullet *= 1.2f;
-            spacingBullet *= 1.1f;
+            Renderer::Instance().InitHeadless(C_WIDTH, C_HEIGHT);
         }
-    }
+        if (options.audio) LoadAudio();
 
-    bool IsAlive() const {
-        return alive;
-    }
+        Reset();
+        player->SetInvulnerable(true);
 
-    Vector2 GetPosition() const {
-        return transform.position;
-    }
+        const BenchScenario scenario = options.scenario;
+        const bool stressAsteroids = scenario == BenchScenario::ASTEROIDS || scenario == BenchScenario::MIXED;
+        const bool stressFire = scenario == BenchScenario::FIRE || scenario == BenchScenario::MIXED;
+        const bool stressExplosions = scenario == BenchScenario::EXPLOSIONS || scenario == BenchScenario::MIXED;
+        const bool stressParticles = scenario == BenchScenario::PARTICLES;
 
-    virtual float GetRadius() const = 0;
+        if (stressFire) {
+            // Fully upgraded weapons: every pickup compounds the fire rate by 1.2x
+            for (int i = 0; i < C_BENCH_WEAPON_UPGRADES; i++) {
+                player->UpgradeWeapon(WeaponType::LASER);
+                player->UpgradeWeapon(WeaponType::BULLET);
+            }
+        }
 
-    int GetHP() const {
-        return hp;
-    }
+        RandomStream& benchRng = Random::Instance().Stream(RandomStreamId::BENCH);
+        const float tickDt = 1.f / tickRate;
+        const int totalTicks = options.warmupTicks + options.ticks;
+        std::vector<int64_t> tickNs;
+        tickNs.reserve(options.ticks);
+        BenchCounter allocs, asteroidCount, projectileCount, explosionCount, powerupCount, particleCount, hudCost;
+        auto benchStart = std::chrono::steady_clock::now();
 
-    int GetMaxHP() const {
-        return maxHp;
-    }
+        for (int t = 0; t < totalTicks; t++) {
+            if (options.render && WindowShouldClose()) break;
 
-    float GetFireRate(WeaponType wt) const {
-        return (wt == WeaponType::LASER) ? fireRateLaser : fireRateBullet;
-    }
+            // The mixer runs at the device's pace, so the sounds of a tick
+            // should reach it as often as in play
+            if (options.audio) {
+                std::this_thread::sleep_until(benchStart + std::chrono::duration<double>(t * static_cast<double>(tickDt)));
+            }
 
-    float GetSpacing(WeaponType wt) const {
-        return (wt == WeaponType::LASER) ? spacingLaser : spacingBullet;
-    }
+            // Scripted input: sweep left and right, fire and switch weapons
+            InputState input;
+            input.down = ((t / 240) % 2) ? BTN_LEFT : BTN_RIGHT;
+            if (stressFire) input.down |= BTN_FIRE;
+            if (t % 600 == 599) input.pressed |= BTN_SWITCH_WEAPON;
+            if (t == 0) input.pressed |= BTN_SHAPE_5;
 
-protected:
-    TransformA transform;
-    int        hp;
-    int        maxHp;
-    float      speed;
-    bool       alive;
-    float      fireRateLaser;
-    float      fireRateBullet;
-    float      spacingLaser;
-    float      spacingBullet;
-};
+            // Scenario load on top of normal gameplay
+            if (stressAsteroids) {
+                if (asteroids.Size() < C_BENCH_MAX_ASTEROIDS) {
+                    asteroids.SpawnWave(benchRng, C_BENCH_MAX_ASTEROIDS - asteroids.Size(),
+                        C_WIDTH, C_HEIGHT, AsteroidShape::RANDOM, 1.f);
+                }
+            }
+            if (stressFire) {
+                // The player's shots are few and fast (~12,000 px/s fully
+                // upgraded), so the store never fills from them alone: slow
+                // volleys from emitters along the bottom edge keep thousands alive
+                for (int i = 0; i < C_BENCH_PROJECTILES_PER_TICK && projectiles.Size() < C_BENCH_MAX_PROJECTILES; i++) {
+                    float x = (i + benchRng.NextFloat(0.f, 1.f)) * (static_cast<float>(C_WIDTH) / C_BENCH_PROJECTILES_PER_TICK);
+                    WeaponType wt = (i % 2) ? WeaponType::BULLET : WeaponType::LASER;
+                    projectiles.Spawn(wt, { x, C_HEIGHT - 1.f }, C_BENCH_PROJECTILE_SPEED);
+                }
+            }
+            if (stressExplosions) {
+                for (int i = 0; i < C_BENCH_EXPLOSIONS_PER_TICK && explosions.Size() < C_BENCH_MAX_EXPLOSIONS; i++) {
+                    explosions.Spawn({ benchRng.NextFloat(0, C_WIDTH), benchRng.NextFloat(0, C_HEIGHT) },
+                        benchRng.NextFloat(16.f, 128.f), 0.5f, ORANGE);
+                }
+            }
+            if (stressParticles) {
+                while (particles.Count() < C_BENCH_PARTICLES) {
+                    Vector2 pos = { benchRng.NextFloat(0, C_WIDTH), benchRng.NextFloat(0, C_HEIGHT) };
+                    particles.Debris(pos, Renderable::SMALL, ORANGE);
+                    particles.Sparks(pos);
+                }
+            }
 
-class PlayerShip :public Ship {
-public:
-    PlayerShip(int w, int h) : Ship(w, h) {
-        texture = LoadTexture("spaceship1.png");
-        GenTextureMipmaps(&texture);
-        SetTextureFilter(texture, 2);
-        scale = 0.25f;
-    }
-    ~PlayerShip() {
-        UnloadTexture(texture);
-    }
+            if (options.audio) MusicStreamer::Instance().SetTrack(level - 1);
 
-    void Update(float dt) override {
-        if (alive) {
-            if (IsKeyDown(KEY_W)) transform.position.y -= speed * dt;
-            if (IsKeyDown(KEY_S)) transform.position.y += speed * dt;
-            if (IsKeyDown(KEY_A)) transform.position.x -= speed * dt;
-            if (IsKeyDown(KEY_D)) transform.position.x += speed * dt;
+            uint64_t allocsBefore = AllocCounter::Get();
+            auto start = std::chrono::steady_clock::now();
+            Tick(tickDt, input);
+            auto end = std::chrono::steady_clock::now();
+            uint64_t allocsAfter = AllocCounter::Get();
 
-            // Keep ship within bounds
-            transform.position.x = std::clamp(transform.position.x, GetRadius(), Renderer::Instance().Width() - GetRadius());
-            transform.position.y = std::clamp(transform.position.y, GetRadius(), Renderer::Instance().Height() - GetRadius());
-        }
-        else {
-            transform.position.y += speed * dt;
+            if (t >= options.warmupTicks) {
+                tickNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+                allocs.Add(allocsAfter - allocsBefore);
+                asteroidCount.Add(asteroids.Size());
+                projectileCount.Add(projectiles.Size());
+                explosionCount.Add(explosions.Size());
+                powerupCount.Add(powerups.Size());
+                particleCount.Add(particles.Count());
+            }
+
+            if (options.render) {
+                Draw(1.f);
+                if (t >= options.warmupTicks) hudCost.Add(lastHudNs);
+            }
         }
-    }
 
-    void Draw() const override {
-        if (!alive && fmodf(GetTime(), 0.4f) > 0.2f) return;
-        Vector2 dstPos = {
-                                         transform.position.x - (texture.width * scale) * 0.5f,
-                                         transform.position.y - (texture.height * scale) * 0.5f
-        };
-        DrawTextureEx(texture, dstPos, 0.0f, scale, WHITE);
+        AssetStats assetStats = AssetCache::Instance().Stats();
+        SoundEffects::Stats audioStats = SoundEffects::Instance().GetStats();
+        bool audioRan = SoundEffects::Instance().Running();
+        MusicStreamer::Stats musicStats = MusicStreamer::Instance().GetStats();
+        bool musicRan = MusicStreamer::Instance().Running();
+        UnloadAudio();
+        if (options.render) {
+            player.reset();
+            UnloadGraphics();
+            Renderer::Instance().Close();
+        }
+        if (tracePath) SaveTrace(tracePath);
+        if (tickNs.empty()) {
+            printf("benchmark: no ticks measured\n");
+            return 1;
+        }
 
-        // Draw health bar
-        if (alive) {
-            float healthPercentage = static_cast<float>(hp) / maxHp;
-            Rectangle backBar = { transform.position.x - 50, transform.position.y - GetRadius() - 20, 100, 10 };
-            Rectangle healthBar = { backBar.x, backBar.y, backBar.width * healthPercentage, backBar.height };
-            
-            DrawRectangleRec(backBar, RED);
-            DrawRectangleRec(healthBar, GREEN);
-            DrawRectangleLinesEx(backBar, 2, DARKGRAY);
+        int samples = static_cast<int>(tickNs.size());
+        printf("scenario: %s  ticks: %d (+%d warmup)  tick rate: %d Hz  kernels: %s  threads: %d  rendering: %s\n",
+            BenchScenarioName(scenario), samples, options.warmupTicks, tickRate,
+            Kernels::useSimd ? "SIMD" : "scalar", Jobs::Scheduler::Instance().ThreadCount(),
+            options.render ? "window" : "null");
+        PrintTickTimes(tickNs);
+        printf("asteroids    avg: %.1f  max: %llu\n", asteroidCount.Average(samples), static_cast<unsigned long long>(asteroidCount.max));
+        printf("projectiles  avg: %.1f  max: %llu  (peak live of %d slots)\n", projectileCount.Average(samples),
+            static_cast<unsigned long long>(projectileCount.max), C_MAX_PROJECTILES);
+        printf("explosions   avg: %.1f  max: %llu\n", explosionCount.Average(samples), static_cast<unsigned long long>(explosionCount.max));
+        printf("powerups     avg: %.1f  max: %llu\n", powerupCount.Average(samples), static_cast<unsigned long long>(powerupCount.max));
+        printf("particles    avg: %.1f  max: %llu\n", particleCount.Average(samples), static_cast<unsigned long long>(particleCount.max));
+        if (options.render) {
+            const TextRenderer::Stats& text = TextRenderer::Instance().GetStats();
+            printf("hud cpu      avg: %.2f us/frame  max: %.2f  (%s, %llu strings shaped, %llu cached)\n", hudCost.Average(samples) / 1000.0,
+                hudCost.max / 1000.0, hudCached ? "cached" : "immediate", static_cast<unsigned long long>(text.misses),
+                static_cast<unsigned long long>(text.hits));
+            printf("assets       hits: %llu  misses: %llu  resident: %d (%.1f KB)\n",
+                static_cast<unsigned long long>(assetStats.hits), static_cast<unsigned long long>(assetStats.misses),
+                assetStats.resident, assetStats.bytes / 1024.0);
         }
-    }
+        if (audioRan) {
+            double mixUs = audioStats.callbacks ? audioStats.mixNs / 1000.0 / audioStats.callbacks : 0.0;
+            double bufferUs = audioStats.callbacks ? audioStats.frames * 1e6 / SoundEffects::SAMPLE_RATE / audioStats.callbacks : 0.0;
+            printf("audio        callbacks: %llu  mix avg: %.2f us  max: %.2f us  (%.3f%% of buffer time)\n",
+                static_cast<unsigned long long>(audioStats.callbacks), mixUs, audioStats.maxMixNs / 1000.0,
+                bufferUs > 0.0 ? 100.0 * mixUs / bufferUs : 0.0);
+            printf("voices       peak: %d/%d  started: %llu  stolen: %llu  dropped: %llu\n", audioStats.peakVoices,
+                SoundEffects::MAX_VOICES, static_cast<unsigned long long>(audioStats.started),
+                static_cast<unsigned long long>(audioStats.stolen), static_cast<unsigned long long>(audioStats.dropped));
+        }
+        if (musicRan) {
+            printf("music        tracks: %d  chunks: %llu  decode avg: %.1f us  max: %.1f us (music thread)\n", musicStats.tracks,
+                static_cast<unsigned long long>(musicStats.chunks),
+                musicStats.chunks ? musicStats.decodeNs / 1000.0 / musicStats.chunks : 0.0, musicStats.maxDecodeNs / 1000.0);
+            printf("music ring   prefetch: %d frames  min buffered: %d  underruns: %llu (%llu frames)\n",
+                musicStats.prefetchFrames, musicStats.minBufferedFrames, static_cast<unsigned long long>(musicStats.underruns),
+                static_cast<unsigned long long>(musicStats.underrunFrames));
+        }
+        printf("allocations  per tick avg: %.3f  max: %llu  total: %llu\n", allocs.Average(samples),
+            static_cast<unsigned long long>(allocs.max), static_cast<unsigned long long>(allocs.total));
+        printf("score: %d  level: %d\n", score, level);
 
-    float GetRadius() const override {
-        return (texture.width * scale) * 0.5f;
+        // Entity pools are sized up front; a measured tick must not touch the heap
+        if (allocs.total > 0) {
+            printf("FAIL: heap allocations in steady state\n");
+            return 3;
+        }
+        return 0;
     }
 
 private:
-    Texture2D texture;
-    float     scale;
-};
-
-// --- POWERUP ---
-enum class PowerUpType { HEALTH, WEAPON_UPGRADE };
-
-struct PowerUp {
-    Vector2 position;
-    PowerUpType type;
-    float radius = 15.f;
-    float rotation = 0.f;
-    float rotationSpeed = 90.f;
-    float lifetime = 10.f;
-    float timer = 0.f;
-
-    PowerUp(Vector2 pos, PowerUpType t) : position(pos), type(t) {}
-
-    bool Update(float dt) {
-        rotation += rotationSpeed * dt;
-        timer += dt;
-        return timer >= lifetime;
+    static void PrintReplayResult(const InputReplay& replay) {
+        printf("checksums: %d/%d verified", replay.Verified(), replay.ChecksumCount());
+        if (replay.Failed() > 0) {
+            printf(", %d MISMATCHED (first at tick %u)", replay.Failed(), replay.FirstMismatchTick());
+        }
+        printf("\n");
     }
 
-    void Draw() const {
-        if (type == PowerUpType::HEALTH) {
-            DrawCircleV(position, radius, GREEN);
-            DrawCircleV(position, radius * 0.6f, LIME);
-            DrawText("+", position.x - 10, position.y - 10, 20, DARKGREEN);
+    // Writes the zones still held by the profiler's per-thread rings.
+    static void SaveTrace(const char* path) {
+        if (!Profiler::ENABLED) {
+            printf("profiler not built in, no trace written (build with PROFILE defined)\n");
+            return;
+        }
+        size_t length = strlen(path);
+        bool csv = length >= 4 && strcmp(path + length - 4, ".csv") == 0;
+        Profiler::Registry& profiler = Profiler::Registry::Instance();
+        if (csv ? profiler.ExportCsv(path) : profiler.ExportChromeTrace(path)) {
+            printf("profiler trace written to %s\n", path);
         }
         else {
-            DrawCircleV(position, radius, BLUE);
-            DrawCircleV(position, radius * 0.6f, SKYBLUE);
-            DrawText("W", position.x - 10, position.y - 10, 20, DARKBLUE);
+            printf("could not write profiler trace '%s'\n", path);
         }
     }
-};
 
-// --- APPLICATION ---
-class Application {
-public:
-    static Application& Instance() {
-        static Application inst;
-        return inst;
+    void Reset() {
+        player.reset();  // Drop the old ship's texture reference first
+        player.emplace(C_WIDTH, C_HEIGHT);
+        asteroids.Clear();
+        projectiles.Clear();
+        explosions.Clear();
+        particles.Clear();
+        powerups.Clear();
+        spawnTimer = 0.f;
+        spawnInterval = Random::Instance().Stream(RandomStreamId::SPAWN).NextFloat(C_SPAWN_MIN, C_SPAWN_MAX);
+        shotTimer = 0.f;
+        score = 0;
+        level = 1;
+        asteroidsDestroyed = 0;
+        asteroidsToNextLevel = 10;
+        gameTime = 0.f;
     }
 
-    void Run() {
-        srand(static_cast<unsigned>(time(nullptr)));
-        Renderer::Instance().Init(C_WIDTH, C_HEIGHT, "Asteroids OOP");
+    // Advances the simulation by one fixed step.
+    void Tick(float dt, const InputState& input) {
+        PROFILE_ZONE("Tick");
+        tickCount++;
+        spawnTimer += dt;
+        gameTime += dt;
 
-        auto player = std::make_unique<PlayerShip>(C_WIDTH, C_HEIGHT);
+        // Remember where everything was for render interpolation
+        player->SavePrevious();
+        asteroids.SavePrevious();
+        projectiles.SavePrevious();
 
-        float spawnTimer = 0.f;
-        float spawnInterval = Utils::RandomFloat(C_SPAWN_MIN, C_SPAWN_MAX);
-        WeaponType currentWeapon = WeaponType::LASER;
-        float shotTimer = 0.f;
-        int score = 0;
-        int level = 1;
-        int asteroidsDestroyed = 0;
-        int asteroidsToNextLevel = 10;
-        float gameTime = 0.f;
+        // Update player
+        player->Update(dt, input);
+        SoundEffects& sfx = SoundEffects::Instance();
+        sfx.SetListener(player->GetPosition());
 
-        while (!WindowShouldClose()) {
-            float dt = GetFrameTime();
-            spawnTimer += dt;
-            gameTime += dt;
-
-            // Update player
-            player->Update(dt);
-
-            // Restart logic
-            if (!player->IsAlive() && IsKeyPressed(KEY_R)) {
-                player = std::make_unique<PlayerShip>(C_WIDTH, C_HEIGHT);
-                asteroids.clear();
-                projectiles.clear();
-                explosions.clear();
-                powerups.clear();
-                spawnTimer = 0.f;
-                spawnInterval = Utils::RandomFloat(C_SPAWN_MIN, C_SPAWN_MAX);
-                score = 0;
-                level = 1;
-                asteroidsDestroyed = 0;
-                asteroidsToNextLevel = 10;
-                gameTime = 0.f;
-            }
-            
-            // Asteroid shape switch
-            if (IsKeyPressed(KEY_ONE)) {
-                currentShape = AsteroidShape::TRIANGLE;
-            }
-            if (IsKeyPressed(KEY_TWO)) {
-                currentShape = AsteroidShape::SQUARE;
-            }
-            if (IsKeyPressed(KEY_THREE)) {
-                currentShape = AsteroidShape::PENTAGON;
-            }
-            if (IsKeyPressed(KEY_FOUR)) {
-                currentShape = AsteroidShape::STAR;
-            }
-            if (IsKeyPressed(KEY_FIVE)) {
-                currentShape = AsteroidShape::RANDOM;
+        // Engine exhaust opposite to the direction of travel
+        if (player->IsAlive()) {
+            Vector2 move = {
+                static_cast<float>(input.Down(BTN_RIGHT)) - static_cast<float>(input.Down(BTN_LEFT)),
+                static_cast<float>(input.Down(BTN_DOWN)) - static_cast<float>(input.Down(BTN_UP))
+            };
+            if (move.x != 0.f || move.y != 0.f) {
+                Vector2 dir = Vector2Negate(Vector2Normalize(move));
+                particles.Thrust(Vector2Add(player->GetPosition(), Vector2Scale(dir, player->GetRadius() * 0.6f)), dir);
             }
+        }
 
-            // Weapon switch
-            if (IsKeyPressed(KEY_TAB)) {
-                currentWeapon = static_cast<WeaponType>((static_cast<int>(currentWeapon) + 1) % static_cast<int>(WeaponType::COUNT));
-            }
+        // Restart logic
+        if (!player->IsAlive() && input.Pressed(BTN_RESTART)) {
+            Reset();
+        }
+        
+        // Asteroid shape switch
+        if (input.Pressed(BTN_SHAPE_1)) {
+            currentShape = AsteroidShape::TRIANGLE;
+        }
+        if (input.Pressed(BTN_SHAPE_2)) {
+            currentShape = AsteroidShape::SQUARE;
+        }
+        if (input.Pressed(BTN_SHAPE_3)) {
+            currentShape = AsteroidShape::PENTAGON;
+        }
+        if (input.Pressed(BTN_SHAPE_4)) {
+            currentShape = AsteroidShape::STAR;
+        }
+        if (input.Pressed(BTN_SHAPE_5)) {
+            currentShape = AsteroidShape::RANDOM;
+        }
 
-            // Shooting
-            if (player->IsAlive() && IsKeyDown(KEY_SPACE)) {
-                shotTimer += dt;
-                float interval = 1.f / player->GetFireRate(currentWeapon);
-                float projSpeed = player->GetSpacing(currentWeapon) * player->GetFireRate(currentWeapon);
+        // Weapon switch
+        if (input.Pressed(BTN_SWITCH_WEAPON)) {
+            currentWeapon = static_cast<WeaponType>((static_cast<int>(currentWeapon) + 1) % static_cast<int>(WeaponType::COUNT));
+        }
 
-                while (shotTimer >= interval) {
-                    Vector2 p = player->GetPosition();
-                    p.y -= player->GetRadius();
-                    projectiles.push_back(MakeProjectile(currentWeapon, p, projSpeed));
-                    shotTimer -= interval;
-                }
+        // Shooting
+        if (player->IsAlive() && input.Down(BTN_FIRE)) {
+            PROFILE_ZONE("Shooting");
+            shotTimer += dt;
+            float interval = 1.f / player->GetFireRate(currentWeapon);
+            float projSpeed = player->GetSpacing(currentWeapon) * player->GetFireRate(currentWeapon);
+
+            while (shotTimer >= interval) {
+                shotTimer -= interval;
+
+                // Shots due earlier in this tick have already travelled for 'shotTimer'
+                Vector2 p = player->GetPosition();
+                p.y -= player->GetRadius() + projSpeed * shotTimer;
+                projectiles.Spawn(currentWeapon, p, projSpeed);
+                sfx.Play(currentWeapon == WeaponType::LASER ? Sfx::LASER : Sfx::BULLET, p);
             }
-            else {
-                float maxInterval = 1.f / player->GetFireRate(currentWeapon);
-                if (shotTimer > maxInterval) {
-                    shotTimer = fmodf(shotTimer, maxInterval);
-                }
+        }
+        else {
+            float maxInterval = 1.f / player->GetFireRate(currentWeapon);
+            if (shotTimer > maxInterval) {
+                shotTimer = fmodf(shotTimer, maxInterval);
             }
+        }
+
+        // Spawn asteroids with level-based difficulty
+        if (spawnTimer >= spawnInterval && asteroids.Size() < MAX_AST) {
+            PROFILE_ZONE("Spawn");
+            // Increase speed based on level
+            float speedMultiplier = 1.0f + (level * 0.1f);
+            RandomStream& rng = Random::Instance().Stream(RandomStreamId::SPAWN);
+            asteroids.Spawn(rng, C_WIDTH, C_HEIGHT, currentShape, speedMultiplier);
+            spawnTimer = 0.f;
+            spawnInterval = rng.NextFloat(C_SPAWN_MIN / (1 + level * 0.1f), C_SPAWN_MAX / (1 + level * 0.1f));
+        }
+
+        // Entity updates and collisions, see BuildTickGraph
+        phaseDt = dt;
+        {
+            PROFILE_ZONE("Tick graph");
+            tickGraph.Run();
+        }
+
+        // Level progression
+        if (asteroidsDestroyed >= asteroidsToNextLevel) {
+            level++;
+            asteroidsDestroyed = 0;
+            asteroidsToNextLevel = 10 + level * 5;
+            
+            // Flash screen when level up
+            explosions.Spawn(
+                Vector2{Renderer::Instance().Width()/2.0f, Renderer::Instance().Height()/2.0f},
+                Renderer::Instance().Width() * 0.8f,
+                1.0f,
+                GREEN);
+            particles.Burst(Vector2{ Renderer::Instance().Width() / 2.0f, Renderer::Instance().Height() / 2.0f },
+                400, 600.f, GREEN);
+            sfx.Play(Sfx::LEVEL_UP, player->GetPosition());
+        }
+    }
+
+    // Per-tick phases. Tasks without an edge between them run concurrently:
+    //
+    //   projectiles  --+
+    //                  +--> collisions --+--> asteroids
+    //   asteroidGrid --+                 +--> explosions
+    //                                    +--> powerups --> pickups
+    //                                    +--> particles
+    void BuildTickGraph() {
+        int moveProjectiles = tickGraph.Add("projectiles", [this] {
+            projectiles.Update(phaseDt, Renderer::Instance().Width(), Renderer::Instance().Height());
+        });
+        int buildGrid = tickGraph.Add("asteroidGrid", [this] { BuildAsteroidGrid(); });
+        int collide = tickGraph.Add("collisions", [this] { ResolveCollisions(); });
+        int moveAsteroids = tickGraph.Add("asteroids", [this] {
+            asteroids.Update(phaseDt, Renderer::Instance().Width(), Renderer::Instance().Height());
+        });
+        int ageExplosions = tickGraph.Add("explosions", [this] { explosions.Update(phaseDt); });
+        int agePowerups = tickGraph.Add("powerups", [this] { powerups.Update(phaseDt); });
+        int pickups = tickGraph.Add("pickups", [this] { CollectPowerups(); });
+        int ageParticles = tickGraph.Add("particles", [this] { particles.Update(phaseDt); });
+
+        tickGraph.Precede(moveProjectiles, collide);
+        tickGraph.Precede(buildGrid, collide);
+        tickGraph.Precede(collide, moveAsteroids);
+        tickGraph.Precede(collide, ageExplosions);
+        tickGraph.Precede(collide, agePowerups);
+        tickGraph.Precede(agePowerups, pickups);
+        tickGraph.Precede(collide, ageParticles);
+    }
+
+    // Broadphase: bin asteroids by position
+    void BuildAsteroidGrid() {
+        asteroidGrid.Clear();
+        for (size_t i = 0; i < asteroids.Size(); i++) {
+            asteroidGrid.Insert(static_cast<int>(i), { asteroids.posX[i], asteroids.posY[i] }, asteroids.radius[i]);
+        }
+        asteroidGrid.Build();
+    }
 
-            // Spawn asteroids with level-based difficulty
-            if (spawnTimer >= spawnInterval && asteroids.size() < MAX_AST) {
-                auto asteroid = MakeAsteroid(C_WIDTH, C_HEIGHT, currentShape);
-                
-                // Increase speed based on level
-                float speedMultiplier = 1.0f + (level * 0.1f);
-                Physics phys = asteroid->GetPhysics();
-                phys.velocity = Vector2Scale(phys.velocity, speedMultiplier);
-                asteroid->SetPhysics(phys);
-                
-                asteroids.push_back(std::move(asteroid));
-                spawnTimer = 0.f;
-                spawnInterval = Utils::RandomFloat(C_SPAWN_MIN / (1 + level * 0.1f), C_SPAWN_MAX / (1 + level * 0.1f));
+    // Projectile and ship hits against the asteroid grid; removes everything that was hit.
+    // The narrow phase runs in parallel: every projectile records, in query
+    // order, the asteroids it overlaps. Hits are then resolved on this thread
+    // in projectile order, each taking the first asteroid no earlier
+    // projectile destroyed, so the outcome is the one a serial pass gives and
+    // replays stay deterministic.
+    void ResolveCollisions() {
+        collisionStats = {};
+        asteroidKills.Reset(asteroids.Size());
+        projectileKills.Reset(projectiles.Size());
+
+        // Projectile-Asteroid collisions
+        std::atomic<int> candidates{ 0 };
+        Jobs::Scheduler::Instance().ParallelFor(projectiles.Size(), C_COLLISION_GRAIN, [&](size_t begin, size_t end) {
+            int visited = 0;
+            for (size_t p = begin; p < end; p++) {
+                const Projectile proj(projectiles, p);
+                int* found = &overlaps[p * C_MAX_OVERLAPS];
+                int count = 0;
+                visited += asteroidGrid.Query(proj.GetPosition(), proj.GetRadius(), [&](int a) -> bool {
+                    const Asteroid ast(asteroids, a);
+                    if (Vector2Distance(proj.GetPosition(), ast.GetPosition()) >= proj.GetRadius() + ast.GetRadius()) return false;
+                    if (count < C_MAX_OVERLAPS) found[count] = a;
+                    return ++count > C_MAX_OVERLAPS;  // Too many to keep: queried again below
+                });
+                overlapCount[p] = static_cast<uint8_t>(count);
             }
+            candidates.fetch_add(visited, std::memory_order_relaxed);
+        });
+        collisionStats.candidatePairs = candidates.load(std::memory_order_relaxed);
 
-            // Update projectiles
-            {
-                auto projectile_to_remove = std::remove_if(projectiles.begin(), projectiles.end(),
-                    [dt](auto& projectile) {
-                        return projectile.Update(dt);
-                    });
-                projectiles.erase(projectile_to_remove, projectiles.end());
-            }
-
-            // Projectile-Asteroid collisions
-            for (auto pit = projectiles.begin(); pit != projectiles.end();) {
-                bool removed = false;
-
-                for (auto ait = asteroids.begin(); ait != asteroids.end(); ++ait) {
-                    float dist = Vector2Distance((*pit).GetPosition(), (*ait)->GetPosition());
-                    if (dist < (*pit).GetRadius() + (*ait)->GetRadius()) {
-                        // Add score
-                        score += (*ait)->GetPoints();
-                        asteroidsDestroyed++;
-                        
-                        // Create explosion
-                        explosions.emplace_back((*ait)->GetPosition(), (*ait)->GetRadius() * 2.0f, 0.5f, 
-                            (*ait)->GetSize() == 1 ? YELLOW : (*ait)->GetSize() == 2 ? ORANGE : RED);
-                        
-                        // Chance to spawn powerup (20%)
-                        if (GetRandomValue(0, 4) == 0) {
-                            PowerUpType type = GetRandomValue(0, 1) ? PowerUpType::HEALTH : PowerUpType::WEAPON_UPGRADE;
-                            powerups.emplace_back((*ait)->GetPosition(), type);
-                        }
-                        
-                        ait = asteroids.erase(ait);
-                        pit = projectiles.erase(pit);
-                        removed = true;
-                        break;
-                    }
-                }
-                if (!removed) {
-                    ++pit;
+        for (size_t p = 0; p < projectiles.Size(); p++) {
+            int count = overlapCount[p];
+            if (count > C_MAX_OVERLAPS) {
+                const Projectile proj(projectiles, p);
+                asteroidGrid.Query(proj.GetPosition(), proj.GetRadius(), [&](int a) -> bool {
+                    if (asteroidKills.Contains(a)) return false;
+                    const Asteroid ast(asteroids, a);
+                    if (Vector2Distance(proj.GetPosition(), ast.GetPosition()) >= proj.GetRadius() + ast.GetRadius()) return false;
+                    HitAsteroid(p, a);
+                    return true;
+                });
+                continue;
+            }
+            for (int k = 0; k < count; k++) {
+                int a = overlaps[p * C_MAX_OVERLAPS + k];
+                if (!asteroidKills.Contains(a)) {
+                    HitAsteroid(p, a);
+                    break;
                 }
             }
+        }
 
-            // Asteroid-Ship collisions
-            {
-                auto remove_collision =
-                    [&player, this, dt](auto& asteroid_ptr_like) -> bool {
-                    if (player->IsAlive()) {
-                        float dist = Vector2Distance(player->GetPosition(), asteroid_ptr_like->GetPosition());
-
-                        if (dist < player->GetRadius() + asteroid_ptr_like->GetRadius()) {
-                            player->TakeDamage(asteroid_ptr_like->GetDamage());
-                            explosions.emplace_back(asteroid_ptr_like->GetPosition(), 
-                                asteroid_ptr_like->GetRadius() * 1.5f, 0.4f, RED);
-                            return true;
-                        }
-                    }
-                    if (!asteroid_ptr_like->Update(dt)) {
-                        return true;
+        // Asteroid-Ship collisions
+        if (player->IsAlive()) {
+            collisionStats.candidatePairs += asteroidGrid.Query(player->GetPosition(), player->GetRadius(),
+                [&](int a) -> bool {
+                    if (asteroidKills.Contains(a)) return false;
+                    const Asteroid ast(asteroids, a);
+                    float dist = Vector2Distance(player->GetPosition(), ast.GetPosition());
+                    if (dist < player->GetRadius() + ast.GetRadius()) {
+                        player->TakeDamage(ast.GetDamage());
+                        explosions.Spawn(ast.GetPosition(), ast.GetRadius() * 1.5f, 0.4f, RED);
+                        particles.Debris(ast.GetPosition(), ast.GetSize(), ast.GetColor());
+                        SoundEffects::Instance().Play(Sfx::HIT, ast.GetPosition());
+                        asteroidKills.Add(a);
+                        collisionStats.hits++;
                     }
-                    return false;
-                };
-                auto asteroid_to_remove = std::remove_if(asteroids.begin(), asteroids.end(), remove_collision);
-                asteroids.erase(asteroid_to_remove, asteroids.end());
-            }
+                    return !player->IsAlive();
+                });
+        }
 
-            // Update explosions
-            {
-                auto explosion_to_remove = std::remove_if(explosions.begin(), explosions.end(),
-                    [dt](auto& explosion) {
-                        return explosion.Update(dt);
-                    });
-                explosions.erase(explosion_to_remove, explosions.end());
-            }
+        // Remove hit entities
+        projectiles.Remove(projectileKills);
+        asteroids.Remove(asteroidKills);
+    }
 
-            // Update powerups
-            {
-                auto powerup_to_remove = std::remove_if(powerups.begin(), powerups.end(),
-                    [dt](auto& powerup) {
-                        return powerup.Update(dt);
-                    });
-                powerups.erase(powerup_to_remove, powerups.end());
-            }
-
-            // Powerup collection
-            if (player->IsAlive()) {
-                for (auto it = powerups.begin(); it != powerups.end();) {
-                    float dist = Vector2Distance(player->GetPosition(), it->position);
-                    if (dist < player->GetRadius() + it->radius) {
-                        if (it->type == PowerUpType::HEALTH) {
-                            player->Heal(25);
-                        }
-                        else {
-                            player->UpgradeWeapon(currentWeapon);
-                        }
-                        it = powerups.erase(it);
+    // Projectile 'p' destroys asteroid 'a'.
+    void HitAsteroid(size_t p, int a) {
+        const Projectile proj(projectiles, p);
+        const Asteroid ast(asteroids, a);
+
+        // Add score
+        score += ast.GetPoints();
+        asteroidsDestroyed++;
+
+        // Create explosion
+        explosions.Spawn(ast.GetPosition(), ast.GetRadius() * 2.0f, 0.5f,
+            ast.GetSize() == 1 ? YELLOW : ast.GetSize() == 2 ? ORANGE : RED);
+        particles.Sparks(proj.GetPosition());
+        particles.Debris(ast.GetPosition(), ast.GetSize(), ast.GetColor());
+        SoundEffects::Instance().Play(Sfx::EXPLOSION, ast.GetPosition(), 0.5f + 0.125f * ast.GetSize());
+
+        // Chance to spawn powerup (20%)
+        RandomStream& drops = Random::Instance().Stream(RandomStreamId::DROPS);
+        if (drops.NextInt(0, 4) == 0) {
+            PowerUpType type = drops.NextInt(0, 1) ? PowerUpType::HEALTH : PowerUpType::WEAPON_UPGRADE;
+            powerups.Spawn(ast.GetPosition(), type);
+        }
+
+        asteroidKills.Add(a);
+        projectileKills.Add(p);
+        collisionStats.hits++;
+    }
+
+    void CollectPowerups() {
+        if (!player->IsAlive()) return;
+
+        powerupGrid.Clear();
+        for (size_t i = 0; i < powerups.Size(); i++) {
+            powerupGrid.Insert(static_cast<int>(i), { powerups.posX[i], powerups.posY[i] }, PowerUpStore::RADIUS);
+        }
+        powerupGrid.Build();
+        powerupKills.Reset(powerups.Size());
+
+        collisionStats.candidatePairs += powerupGrid.Query(player->GetPosition(), player->GetRadius(),
+            [&](int i) -> bool {
+                Vector2 position = { powerups.posX[i], powerups.posY[i] };
+                float dist = Vector2Distance(player->GetPosition(), position);
+                if (dist < player->GetRadius() + PowerUpStore::RADIUS) {
+                    if (static_cast<PowerUpType>(powerups.type[i]) == PowerUpType::HEALTH) {
+                        player->Heal(25);
                     }
                     else {
-                        ++it;
+                        player->UpgradeWeapon(currentWeapon);
                     }
+                    powerupKills.Add(i);
+                    SoundEffects::Instance().Play(Sfx::POWERUP, position);
                 }
-            }
+                return false;
+            });
+        powerups.Remove(powerupKills);
+    }
 
-            // Level progression
-            if (asteroidsDestroyed >= asteroidsToNextLevel) {
-                level++;
-                asteroidsDestroyed = 0;
-                asteroidsToNextLevel = 10 + level * 5;
-                
-                // Flash screen when level up
-                explosions.emplace_back(
-                    Vector2{Renderer::Instance().Width()/2.0f, Renderer::Instance().Height()/2.0f},
-                    Renderer::Instance().Width() * 0.8f,
-                    1.0f,
-                    GREEN);
-            }
+    // Renders the world 'alpha' of the way from the previous tick to the current one.
+    void Draw(float alpha) {
+        PROFILE_ZONE("Draw");
+        Renderer::Instance().Begin();
 
-            // Render everything
-            {
-                Renderer::Instance().Begin();
-
-                // Draw HUD
-                DrawText(TextFormat("HP: %d/%d", player->GetHP(), player->GetMaxHP()), 10, 10, 20, GREEN);
-                DrawText(TextFormat("Score: %d", score), 10, 40, 20, YELLOW);
-                DrawText(TextFormat("Level: %d", level), 10, 70, 20, BLUE);
-                DrawText(TextFormat("Time: %.1f", gameTime), 10, 100, 20, WHITE);
-                
-                const char* weaponName = (currentWeapon == WeaponType::LASER) ? "LASER" : "BULLET";
-                DrawText(TextFormat("Weapon: %s (TAB to switch)", weaponName), 10, 130, 20, SKYBLUE);
-                
-                // Draw controls info
-                DrawText("Controls: WASD - Move, SPACE - Shoot, 1-5 - Asteroid Shapes, R - Restart", 
-                    10, Renderer::Instance().Height() - 30, 20, GRAY);
-
-                // Draw explosions
-                for (const auto& explosion : explosions) {
-                    explosion.Draw();
-                }
+        // HUD text is queued here and drawn with all other text at the end of
+        // the frame. The debug stats (F1) are sampled a few times per second.
+        auto hudStart = std::chrono::steady_clock::now();
+        if (showDebugStats) SampleHudStats();
+        TextRenderer& text = TextRenderer::Instance();
+        text.SetCaching(hudCached);
+        {
+            PROFILE_ZONE("HUD");
+            DrawHudText();
+        }
+        int64_t hudNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - hudStart).count();
 
-                // Draw powerups
-                for (const auto& powerup : powerups) {
-                    powerup.Draw();
-                }
+        // Draw explosions
+        explosions.Draw();
 
-                // Draw projectiles
-                for (const auto& projPtr : projectiles) {
-                    projPtr.Draw();
-                }
+        // Draw powerups
+        powerups.Draw();
 
-                // Draw asteroids
-                for (const auto& astPtr : asteroids) {
-                    astPtr->Draw();
-                }
+        // Draw projectiles
+        projectiles.Draw(alpha);
 
-                // Draw player
-                player->Draw();
-
-                // Game over screen
-                if (!player->IsAlive()) {
-                    DrawRectangle(0, 0, Renderer::Instance().Width(), Renderer::Instance().Height(), Fade(BLACK, 0.7f));
-                    DrawText("GAME OVER", 
-                        Renderer::Instance().Width()/2 - MeasureText("GAME OVER", 60)/2, 
-                        Renderer::Instance().Height()/2 - 100, 60, RED);
-                    DrawText(TextFormat("Final Score: %d", score), 
-                        Renderer::Instance().Width()/2 - MeasureText(TextFormat("Final Score: %d", score), 40)/2, 
-                        Renderer::Instance().Height()/2, 40, WHITE);
-                    DrawText("Press R to restart", 
-                        Renderer::Instance().Width()/2 - MeasureText("Press R to restart", 30)/2, 
-                        Renderer::Instance().Height()/2 + 100, 30, GREEN);
-                }
+        // Draw asteroids
+        asteroids.Draw(alpha);
 
-                // Level up notification
-                if (asteroidsDestroyed >= asteroidsToNextLevel - 3 && asteroidsDestroyed < asteroidsToNextLevel) {
-                    DrawText(TextFormat("Next level in: %d", asteroidsToNextLevel - asteroidsDestroyed),
-                        Renderer::Instance().Width()/2 - MeasureText(TextFormat("Next level in: %d", asteroidsToNextLevel - asteroidsDestroyed), 30)/2,
-                        50, 30, GREEN);
-                }
+        // Particles flush the queued shapes before drawing on top of them
+        particles.Draw(alpha);
 
-                Renderer::Instance().End();
-            }
+        // Draw player
+        player->Draw(alpha);
+
+        // Game over screen and level notice on top of everything
+        hudStart = std::chrono::steady_clock::now();
+        bool levelNotice = asteroidsDestroyed >= asteroidsToNextLevel - 3 && asteroidsDestroyed < asteroidsToNextLevel;
+        if (!player->IsAlive()) {
+            DrawRectangle(0, 0, Renderer::Instance().Width(), Renderer::Instance().Height(), Fade(BLACK, 0.7f));
+        }
+        DrawOverlayText(levelNotice);
+        {
+            // One draw for all text of the frame, above the game objects
+            PROFILE_ZONE("Text");
+            Renderer::Instance().Shapes().Flush();
+            text.Flush();
+        }
+        hudNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - hudStart).count();
+
+        lastHudNs = hudNs;
+        hudCostNs += (static_cast<double>(hudNs) - hudCostNs) * 0.05;
+
+        if (showProfiler) {
+            PROFILE_ZONE("Profiler overlay");
+            frameProfile.Draw(Renderer::Instance().Width() - 480, 10);
+        }
+
+        Renderer::Instance().End();
+    }
+
+    void SampleHudStats() {
+        double now = GetTime();
+        if (now < nextHudSample) return;
+        nextHudSample = now + C_HUD_SAMPLE_INTERVAL;
+        hudStats.sample++;
+        hudStats.candidatePairs = collisionStats.candidatePairs;
+        hudStats.hits = collisionStats.hits;
+        hudStats.shapes = Renderer::Instance().Shapes().Instances();
+        hudStats.drawCalls = Renderer::Instance().Shapes().DrawCalls();
+        const rlRenderBatchStats& batch = Renderer::Instance().BatchStats();
+        hudStats.batchFlushes = static_cast<int>(batch.flushes);
+        hudStats.batchDraws = static_cast<int>(batch.drawCalls);
+        hudStats.batchBinds = static_cast<int>(batch.textureBinds);
+        hudStats.batchKb = static_cast<int>(batch.bytesUploaded / 1024);
+        hudStats.batchStalls = static_cast<int>(batch.stalls);
+        hudStats.particles = static_cast<int>(particles.Count());
+        hudStats.hudTenthsUs = static_cast<int>(hudCostNs / 100.0);
+        hudStats.cached = hudCached;
+        SoundEffects::Stats audio = SoundEffects::Instance().GetStats();
+        hudStats.voices = audio.voices;
+        hudStats.peakVoices = audio.peakVoices;
+        hudStats.stolenVoices = static_cast<int>(audio.stolen);
+        hudStats.mixTenthsUs = audio.callbacks ? static_cast<int>(audio.mixNs / 100 / audio.callbacks) : 0;
+        MusicStreamer::Stats music = MusicStreamer::Instance().GetStats();
+        hudStats.musicTrack = music.tracks > 0 ? music.track + 1 : 0;
+        hudStats.musicTracks = music.tracks;
+        hudStats.musicBufferedMs = music.bufferedFrames * 1000 / MusicStreamer::SAMPLE_RATE;
+        hudStats.musicUnderruns = static_cast<int>(music.underruns);
+    }
+
+    static uint64_t HudKey(int a, int b = 0) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+    }
+
+    // Every line is a label keyed on the values it shows, so it is formatted
+    // and shaped again only when they change; the debug lines change with
+    // each stats sample.
+    void DrawHudText() {
+        TextRenderer& text = TextRenderer::Instance();
+        TextRenderer::Label* line = hudLines;
+        int tenths = static_cast<int>(gameTime * 10.f);
+        text.Draw(line[0].Format(HudKey(player->GetHP(), player->GetMaxHP()), "HP: %d/%d", player->GetHP(), player->GetMaxHP()),
+            10, 10, 20, GREEN);
+        text.Draw(line[1].Format(HudKey(score), "Score: %d", score), 10, 40, 20, YELLOW);
+        text.Draw(line[2].Format(HudKey(level), "Level: %d", level), 10, 70, 20, BLUE);
+        text.Draw(line[3].Format(HudKey(tenths), "Time: %d.%d", tenths / 10, tenths % 10), 10, 100, 20, WHITE);
+
+        const char* weaponName = (currentWeapon == WeaponType::LASER) ? "LASER" : "BULLET";
+        text.Draw(line[4].Format(HudKey(static_cast<int>(currentWeapon)), "Weapon: %s (TAB to switch)", weaponName),
+            10, 130, 20, SKYBLUE);
+        text.Draw(line[5].Format(0, "%s", "Controls: WASD - Move, SPACE - Shoot, 1-5 - Asteroid Shapes, R - Restart"),
+            10, Renderer::Instance().Height() - 30, 20, GRAY);
+        if (!showDebugStats) return;
+
+        uint64_t sample = hudStats.sample;
+        text.Draw(line[6].Format(sample, "Collision pairs: %d (hits: %d)", hudStats.candidatePairs, hudStats.hits),
+            10, 160, 20, DARKGRAY);
+        text.Draw(line[7].Format(HudKey(Kernels::useSimd), "Kernels: %s (F2 to switch)", Kernels::useSimd ? "SIMD" : "scalar"),
+            10, 190, 20, DARKGRAY);
+        text.Draw(line[8].Format(sample, "Shapes: %d in %d draw calls", hudStats.shapes, hudStats.drawCalls), 10, 220, 20, DARKGRAY);
+        text.Draw(line[9].Format(sample, "Particles: %d", hudStats.particles), 10, 250, 20, DARKGRAY);
+        text.Draw(line[10].Format(sample, "HUD: %d.%d us/frame, %s (F3 to switch)", hudStats.hudTenthsUs / 10,
+            hudStats.hudTenthsUs % 10, hudStats.cached ? "cached" : "immediate"), 10, 280, 20, DARKGRAY);
+        text.Draw(line[11].Format(sample, "Batch: %d flushes, %d KB, %d stalls per frame", hudStats.batchFlushes,
+            hudStats.batchKb, hudStats.batchStalls), 10, 310, 20, DARKGRAY);
+        text.Draw(line[12].Format(sample, "Batch draws: %d, texture binds: %d", hudStats.batchDraws, hudStats.batchBinds),
+            10, 340, 20, DARKGRAY);
+        text.Draw(line[13].Format(sample, "Audio: %d/%d voices (peak %d, %d stolen), mix %d.%d us", hudStats.voices,
+            SoundEffects::MAX_VOICES, hudStats.peakVoices, hudStats.stolenVoices, hudStats.mixTenthsUs / 10,
+            hudStats.mixTenthsUs % 10), 10, 370, 20, DARKGRAY);
+        text.Draw(line[14].Format(sample, "Music: track %d/%d, %d ms buffered, %d underruns", hudStats.musicTrack,
+            hudStats.musicTracks, hudStats.musicBufferedMs, hudStats.musicUnderruns), 10, 400, 20, DARKGRAY);
+    }
+
+    static void DrawTextCentered(const char* str, int y, int fontSize, Color color) {
+        TextRenderer& text = TextRenderer::Instance();
+        text.Draw(str, Renderer::Instance().Width() / 2 - text.Measure(str, fontSize) / 2, y, fontSize, color);
+    }
+
+    void DrawOverlayText(bool levelNotice) const {
+        if (!player->IsAlive()) {
+            DrawTextCentered("GAME OVER", Renderer::Instance().Height() / 2 - 100, 60, RED);
+            DrawTextCentered(TextFormat("Final Score: %d", score), Renderer::Instance().Height() / 2, 40, WHITE);
+            DrawTextCentered("Press R to restart", Renderer::Instance().Height() / 2 + 100, 30, GREEN);
+        }
+        if (levelNotice) {
+            DrawTextCentered(TextFormat("Next level in: %d", asteroidsToNextLevel - asteroidsDestroyed), 50, 30, GREEN);
         }
     }
 
-private:
+    // Everything drawn is loaded up front, so restarts and respawns only take
+    // references to resident assets.
+    // The sprites and the SDF glyphs go into the atlas; only without one are
+    // their textures loaded on their own.
+    void LoadGraphics() {
+        SpriteAtlas& atlas = SpriteAtlas::Instance();
+        TextRenderer& text = TextRenderer::Instance();
+        text.Bake();
+        for (const char* path : C_ATLAS_SPRITES) atlas.Add(path);
+        if (!atlas.Build()) {
+            AssetCache::Instance().Preload(C_ASSET_MANIFEST, std::size(C_ASSET_MANIFEST));
+        }
+        particles.Load();
+        text.Load();
+    }
+
+    // Without a playback device miniaudio's null backend runs the mixers silently.
+    void LoadAudio() {
+        InitAudioDevice();
+        if (!SoundEffects::Instance().Load()) TraceLog(LOG_WARNING, "AUDIO: Sound effects disabled");
+        MusicStreamer& music = MusicStreamer::Instance();
+        music.SetTrack(level - 1);
+        if (!music.Load()) TraceLog(LOG_INFO, "AUDIO: No music in %s", MusicStreamer::MUSIC_DIR);
+    }
+
+    void UnloadAudio() {
+        if (!IsAudioDeviceReady()) return;
+        MusicStreamer::Instance().Unload();
+        SoundEffects::Instance().Unload();
+        CloseAudioDevice();
+    }
+
+    void UnloadGraphics() {
+        TextRenderer::Instance().Unload();
+        particles.Unload();
+        const AssetStats& stats = AssetCache::Instance().Stats();
+        TraceLog(LOG_INFO, "ASSETS: %llu hits, %llu misses, %d resident (%.1f KB)",
+            static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses),
+            stats.resident, stats.bytes / 1024.0);
+        AssetCache::Instance().ReleasePreloaded();
+        SpriteAtlas::Instance().Unload();
+    }
+
     Application()
+        : asteroidGrid(C_WIDTH, C_HEIGHT, C_GRID_MARGIN, C_GRID_CELL)
+        , powerupGrid(C_WIDTH, C_HEIGHT, C_GRID_MARGIN, C_GRID_CELL)
     {
-        asteroids.reserve(1000);
-        projectiles.reserve(10'000);
-        explosions.reserve(100);
-        powerups.reserve(20);
+        asteroids.SetCapacity(C_MAX_ASTEROIDS);
+        projectiles.SetCapacity(C_MAX_PROJECTILES);
+        explosions.SetCapacity(C_MAX_EXPLOSIONS);
+        powerups.SetCapacity(C_MAX_POWERUPS);
+
+        asteroidGrid.Reserve(C_MAX_ASTEROIDS);
+        powerupGrid.Reserve(C_MAX_POWERUPS);
+        asteroidKills.Reserve(C_MAX_ASTEROIDS);
+        projectileKills.Reserve(C_MAX_PROJECTILES);
+        overlapCount.resize(C_MAX_PROJECTILES);
+        overlaps.resize(static_cast<size_t>(C_MAX_PROJECTILES) * C_MAX_OVERLAPS);
+        powerupKills.Reserve(C_MAX_POWERUPS);
+
+        BuildTickGraph();
+    };
+
+    AsteroidStore   asteroids;
+    ProjectileStore projectiles;
+    ExplosionStore  explosions;
+    PowerUpStore    powerups;
+    ParticleSystem  particles;
+
+    SpatialGrid asteroidGrid;
+    SpatialGrid powerupGrid;
+    KillList asteroidKills;
+    KillList projectileKills;
+    std::vector<uint8_t> overlapCount;  // Per projectile, from the narrow phase
+    std::vector<int> overlaps;          // C_MAX_OVERLAPS asteroids per projectile
+    KillList powerupKills;
+    CollisionStats collisionStats;
+
+    // Debug values shown in the HUD, refreshed every C_HUD_SAMPLE_INTERVAL
+    struct HudStats {
+        int candidatePairs = 0;
+        int hits = 0;
+        int shapes = 0;
+        int drawCalls = 0;
+        int batchFlushes = 0;
+        int batchDraws = 0;
+        int batchBinds = 0;
+        int batchKb = 0;
+        int batchStalls = 0;
+        int particles = 0;
+        int hudTenthsUs = 0;
+        int cached = 0;
+        int voices = 0;
+        int peakVoices = 0;
+        int stolenVoices = 0;
+        int mixTenthsUs = 0;
+        int musicTrack = 0;
+        int musicTracks = 0;
+        int musicBufferedMs = 0;
+        int musicUnderruns = 0;
+        uint64_t sample = 0;  // Bumped by every SampleHudStats
     };
 
-    std::vector<std::unique_ptr<Asteroid>> asteroids;
-    std::vector<Projectile> projectiles;
-    std::vector<Explosion> explosions;
-    std::vector<PowerUp> powerups;
+    HudStats hudStats;
+    TextRenderer::Label hudLines[15];
+    bool hudCached = true;
+    bool showDebugStats = false;
+    double nextHudSample = 0.0;
+    double hudCostNs = 0.0;  // Moving average of the HUD's CPU time per frame
+    int64_t lastHudNs = 0;
+    Profiler::FrameHistory frameProfile;  // Main thread zones, for the overlay
+    bool showProfiler = false;
+    const char* tracePath = nullptr;
+    Jobs::TaskGraph tickGraph;
+    float phaseDt = 0.f;  // Step of the tick the graph is running
 
     AsteroidShape currentShape = AsteroidShape::TRIANGLE;
 
+    std::optional<PlayerShip> player;  // Rebuilt in place on restart
+    float spawnTimer = 0.f;
+    float spawnInterval = 0.f;
+    WeaponType currentWeapon = WeaponType::LASER;
+    float shotTimer = 0.f;
+    int score = 0;
+    int level = 1;
+    int asteroidsDestroyed = 0;
+    int asteroidsToNextLevel = 10;
+    float gameTime = 0.f;
+
+    int tickRate = C_TICK_RATE;
+    uint32_t tickCount = 0;  // Ticks simulated since start-up (not reset on restart)
+    int renderFps = 60;
+    bool renderVsync = false;
+
     static constexpr int C_WIDTH = 1600;
     static constexpr int C_HEIGHT = 900;
     static constexpr size_t MAX_AST = 150;
     static constexpr float C_SPAWN_MIN = 0.5f;
     static constexpr float C_SPAWN_MAX = 3.0f;
 
+    static constexpr int C_TICK_RATE = 120;
+    static constexpr int C_CHECKSUM_INTERVAL = 60;  // Ticks between recorded world checksums
+    static constexpr float C_MAX_FRAME_TIME = 0.25f;  // Drop time after a hitch instead of spiralling
+    static constexpr double C_HUD_SAMPLE_INTERVAL = 0.25;
+    static constexpr const char* C_TRACE_JSON = "trace.json";  // F5 captures
+    static constexpr const char* C_TRACE_CSV = "trace.csv";
+
+    static constexpr const char* C_ATLAS_SPRITES[] = { PlayerShip::TEXTURE_PATH, ParticleSystem::SPARK_PATH };
+
+    // Stand-ins for the atlas when it cannot be built.
+    static constexpr AssetManifestEntry C_ASSET_MANIFEST[] = {
+        { AssetType::TEXTURE, PlayerShip::TEXTURE_PATH, nullptr, true, PlayerShip::TEXTURE_FILTER },
+        { AssetType::TEXTURE, ParticleSystem::SPARK_PATH },
+    };
+
     static constexpr int C_MAX_ASTEROIDS = 1000;
     static constexpr int C_MAX_PROJECTILES = 10'000;
+    static constexpr int C_MAX_EXPLOSIONS = 8'192;
+    static constexpr int C_MAX_POWERUPS = 256;
+
+    static constexpr int C_BENCH_WEAPON_UPGRADES = 12;
+    static constexpr int C_BENCH_PROJECTILES_PER_TICK = 32;
+    static constexpr float C_BENCH_PROJECTILE_SPEED = 300.f;  // ~3 s to cross the screen
+    static constexpr size_t C_BENCH_MAX_PROJECTILES = 8'000;
+    static constexpr size_t C_BENCH_MAX_ASTEROIDS = C_MAX_ASTEROIDS;
+    static constexpr int C_BENCH_EXPLOSIONS_PER_TICK = 50;
+    static constexpr size_t C_BENCH_MAX_EXPLOSIONS = 5'000;
+    static constexpr size_t C_BENCH_PARTICLES = 100'000;
+
+    // Largest asteroid radius is 16 * LARGE = 64px; cells are twice that so a
+    // query never spans more than 2x2 cells for projectiles.
+    static constexpr float C_GRID_CELL = 128.f;
+    static constexpr size_t C_COLLISION_GRAIN = 256;  // Projectiles per narrow phase job
+    static constexpr int C_MAX_OVERLAPS = 4;          // Asteroids kept per projectile; more are queried again
+    static constexpr float C_GRID_MARGIN = 64.f;
 };
 
-int main() {
-    Application::Instance().Run();
+static void PrintUsage(const char* exe) {
+    printf("usage: %s [options]\n"
+        "  --bench <mixed|asteroids|fire|explosions|particles>  run a headless benchmark and exit\n"
+        "  --ticks <n>        measured benchmark ticks (default 10000)\n"
+        "  --warmup <n>       unmeasured warmup ticks (default 600)\n"
+        "  --render           draw benchmark ticks into a window instead of null rendering\n"
+        "  --audio            mix the benchmark's sound effects and music, ticking in real time\n"
+        "  --tick-rate <hz>   simulation rate (default 120)\n"
+        "  --fps <n>          render frame cap, 0 = uncapped (default 60)\n"
+        "  --vsync            sync presentation to the display\n"
+        "  --seed <n>         random seed\n"
+        "  --record <file>    record the session's input and world checksums\n"
+        "  --replay <file>    play back a recording and verify its checksums\n"
+        "  --headless         with --replay: run without a window, as fast as possible\n"
+        "  --scalar           use the scalar kernels instead of SIMD\n"
+        "  --threads <n>      simulation threads, 1 = run everything inline (default: all cores)\n"
+        "  --hud-immediate    shape the text again every frame instead of caching it (F3 in game)\n"
+        "  --music-prefetch <ms>  music decoded ahead of playback (default 250)\n"
+        "  --trace <file>     write the profiler capture on exit, Chrome trace JSON or .csv\n", exe);
+}
+
+// Whole decimal number in [min, INT_MAX]; false for anything else.
+static bool ParseCount(const char* text, int min, int& out) {
+    char* end = nullptr;
+    errno = 0;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || value < min || value > INT_MAX) return false;
+    out = static_cast<int>(value);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Application& app = Application::Instance();
+    BenchOptions bench;
+    bool runBench = false;
+    bool seeded = false;
+    uint64_t seed = 0;
+    int fps = 60;
+    bool vsync = false;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    bool headless = false;
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--bench") == 0 && value) {
+            if (!ParseBenchScenario(value, bench.scenario)) {
+                printf("unknown scenario '%s'\n", value);
+                return 1;
+            }
+            runBench = true;
+            i++;
+        }
+        else if (strcmp(arg, "--ticks") == 0 && value) {
+            if (!ParseCount(value, 1, bench.ticks)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--warmup") == 0 && value) {
+            if (!ParseCount(value, 0, bench.warmupTicks)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--render") == 0) { bench.render = true; }
+        else if (strcmp(arg, "--audio") == 0) { bench.audio = true; }
+        else if (strcmp(arg, "--tick-rate") == 0 && value) { app.SetTickRate(atoi(value)); i++; }
+        else if (strcmp(arg, "--fps") == 0 && value) { fps = atoi(value); i++; }
+        else if (strcmp(arg, "--vsync") == 0) { vsync = true; }
+        else if (strcmp(arg, "--seed") == 0 && value) { seed = strtoull(value, nullptr, 10); seeded = true; i++; }
+        else if (strcmp(arg, "--scalar") == 0) { Kernels::useSimd = false; }
+        else if (strcmp(arg, "--record") == 0 && value) { recordPath = value; i++; }
+        else if (strcmp(arg, "--replay") == 0 && value) { replayPath = value; i++; }
+        else if (strcmp(arg, "--headless") == 0) { headless = true; }
+        else if (strcmp(arg, "--threads") == 0 && value) { threads = atoi(value); i++; }
+        else if (strcmp(arg, "--hud-immediate") == 0) { app.SetHudCached(false); }
+        else if (strcmp(arg, "--trace") == 0 && value) { app.SetTracePath(value); i++; }
+        else if (strcmp(arg, "--music-prefetch") == 0 && value) { MusicStreamer::Instance().SetPrefetch(atoi(value)); i++; }
+        else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!seeded) seed = static_cast<uint64_t>(time(nullptr));
+    Random::Instance().Seed(seed);
+    Jobs::Scheduler::Instance().Start(threads);
+    PROFILE_THREAD("main");
+
+    if (runBench) {
+        return app.RunBenchmark(bench);
+    }
+
+    app.SetRenderRate(fps, vsync);
+
+    if (replayPath) {
+        InputReplay replay;
+        if (!replay.Load(replayPath)) {
+            printf("could not read replay '%s'\n", replayPath);
+            return 1;
+        }
+        // The recording fixes everything the simulation depends on
+        Random::Instance().Seed(replay.Seed());
+        app.SetTickRate(replay.TickRate());
+        if (headless) {
+            return app.RunReplayHeadless(replay);
+        }
+        app.Run(nullptr, &replay);
+        return replay.Failed() == 0 ? 0 : 2;
+    }
+
+    if (recordPath) {
+        InputRecorder recorder(Random::Instance().GetSeed(), app.GetTickRate(), Application::ChecksumInterval());
+        app.Run(&recorder, nullptr);
+        if (!recorder.Save(recordPath)) {
+            printf("could not write recording '%s'\n", recordPath);
+            return 1;
+        }
+        return 0;
+    }
+
+    app.Run();
     return 0;
 }
\ No newline at end of file
@@ -2,13 +2,1841 @@
 #define RLIGHTS_IMPLEMENTATION
 #include "rlights.h"
 #include "raymath.h"
+#include "rlgl.h"
+#include "external/glad.h"      // Program binaries, which rlgl does not wrap
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #define GLSL_VERSION            330
 
-int main(void)
+#define SCENE_MODELS            3           // Watermill, church, barracks
+#define SCENE_MODEL_SCALE       0.2f
+#define SCENE_SPACING           8.0f        // Between instances of the stress scene
+#define SCENE_STRESS_INSTANCES  3000
+#define SCENE_LIGHTS            4           // Toggled with Y, R, G, B; further lights are scattered over the scene
+
+//----------------------------------------------------------------------------------
+// Cooked meshes
+// "--cook model.obj" converts an OBJ offline into model.amesh: indexed vertex
+// streams laid out the way UploadMesh() takes them, plus per-part bounds and
+// material references. At runtime the file is memory-mapped and the streams are
+// uploaded straight from the mapping, with no parsing and no intermediate copies.
+// A cooked file records the size and time of its source; when they no longer
+// match, the OBJ is parsed instead.
+//----------------------------------------------------------------------------------
+#define COOKED_MESH_VERSION     1
+#define COOKED_MESH_ALIGN       16          // Every stream and string starts at a multiple of this
+#define COOKED_PART_VERTICES    65535       // Parts use 16-bit indices
+
+typedef enum {
+	COOKED_STREAM_TEXCOORDS = 1,
+	COOKED_STREAM_NORMALS = 2
+} CookedStream;
+
+// File layout (little endian): header, part table, material table, then the
+// streams and material strings, all located by offsets from the file start
+typedef struct CookedHeader {
+	char magic[4];                  // "AMSH"
+	unsigned int version;           // COOKED_MESH_VERSION
+	long long sourceSize;           // Source file size and modification time when cooked
+	long long sourceModTime;
+	unsigned int partCount;
+	unsigned int materialCount;
+	unsigned int streams;           // CookedStream flags, the same for every part
+	unsigned int reserved;
+} CookedHeader;
+
+typedef struct CookedPart {
+	unsigned int vertexCount;
+	unsigned int indexCount;
+	int material;                   // Index into the material table, -1 for none
+	unsigned int reserved;
+	float boundsMin[3];
+	float boundsMax[3];
+	unsigned long long positions;   // float xyz
+	unsigned long long texcoords;   // float uv, 0 if not present
+	unsigned long long normals;     // float xyz, 0 if not present
+	unsigned long long indices;     // unsigned short
+} CookedPart;
+
+// The material table holds one offset per material: a NUL-terminated diffuse
+// map path relative to the source file, or 0 if the material has none
+static_assert(sizeof(CookedHeader) == 40, "CookedHeader layout is part of the file format");
+static_assert(sizeof(CookedPart) == 72, "CookedPart layout is part of the file format");
+
+// Indexed mesh data read from an OBJ, split in parts per material and every COOKED_PART_VERTICES
+struct MeshPart
+{
+	std::vector<float> positions;
+	std::vector<float> texcoords;
+	std::vector<float> normals;
+	std::vector<unsigned short> indices;
+	int material = -1;
+	BoundingBox bounds = { 0 };
+};
+
+struct MeshData
+{
+	std::vector<MeshPart> parts;
+	std::vector<std::string> materialMaps;  // Diffuse map per material, empty if none
+	bool hasTexcoords = false;
+	bool hasNormals = false;
+};
+
+// Directory part of a path including the trailing separator ("" if none);
+// unlike GetDirectoryPath() it is safe to call from worker threads
+static std::string DirectoryOf(const char *fileName)
+{
+	const char *slash = strrchr(fileName, '/');
+	const char *backslash = strrchr(fileName, '\\');
+	if (backslash > slash) slash = backslash;
+	return slash ? std::string(fileName, slash + 1) : std::string();
+}
+
+// Case-insensitive extension test (ext with its dot); unlike IsFileExtension()
+// it does not go through TextSplit()/TextToLower() and their static buffers
+static bool HasExtension(const char *fileName, const char *ext)
+{
+	const char *dot = GetFileExtension(fileName);
+	if (dot == nullptr) return false;
+	for (; (*dot != '\0') && (*ext != '\0'); dot++, ext++)
+	{
+		if (tolower((unsigned char)*dot) != tolower((unsigned char)*ext)) return false;
+	}
+	return (*dot == '\0') && (*ext == '\0');
+}
+
+// "dir/model.obj" -> "dir/model.amesh"
+static std::string CookedPath(const char *sourceFile)
+{
+	std::string path = sourceFile;
+	size_t dot = path.find_last_of('.');
+	size_t slash = path.find_last_of("/\\");
+	if ((dot != std::string::npos) && ((slash == std::string::npos) || (dot > slash))) path.erase(dot);
+	return path + ".amesh";
+}
+
+static bool LineKeyword(const char *line, const char *keyword)
+{
+	size_t length = strlen(keyword);
+	return (strncmp(line, keyword, length) == 0) && ((line[length] == ' ') || (line[length] == '\t'));
+}
+
+// Rest of the line after the keyword, without surrounding blanks
+static std::string LineArgument(const char *line, const char *keyword)
+{
+	const char *start = line + strlen(keyword);
+	while ((*start == ' ') || (*start == '\t')) start++;
+	const char *end = start;
+	while ((*end != '\0') && (*end != '\n') && (*end != '\r')) end++;
+	while ((end > start) && ((end[-1] == ' ') || (end[-1] == '\t'))) end--;
+	return std::string(start, end);
+}
+
+static int MaterialIndex(std::vector<std::string> *names, std::vector<std::string> *maps, const std::string &name)
+{
+	for (size_t i = 0; i < names->size(); i++) if ((*names)[i] == name) return (int)i;
+	names->push_back(name);
+	maps->emplace_back();
+	return (int)names->size() - 1;
+}
+
+// Only material names and their diffuse maps (newmtl, map_Kd) are used
+static void ReadMTL(const char *fileName, std::vector<std::string> *names, std::vector<std::string> *maps)
 {
+	char *text = LoadFileText(fileName);
+	if (text == nullptr) return;
+
+	int current = -1;
+	for (const char *p = text; *p != '\0';)
+	{
+		const char *line = p;
+		while ((*p != '\0') && (*p != '\n')) p++;
+		if (*p == '\n') p++;
+		while ((*line == ' ') || (*line == '\t')) line++;
+
+		if (LineKeyword(line, "newmtl")) current = MaterialIndex(names, maps, LineArgument(line, "newmtl"));
+		else if (LineKeyword(line, "map_Kd") && (current >= 0)) (*maps)[current] = LineArgument(line, "map_Kd");
+	}
+	UnloadFileText(text);
+}
+
+struct ObjCorner { int v, vt, vn; };
+
+// Corners are v, v/vt, v//vn or v/vt/vn; negative indices count from the end.
+// Missing or out of range vt/vn become -1.
+static bool ParseFace(char *cursor, int positionCount, int texcoordCount, int normalCount, std::vector<ObjCorner> *face)
+{
+	face->clear();
+	while (true)
+	{
+		while ((*cursor == ' ') || (*cursor == '\t')) cursor++;
+		if ((*cursor == '\0') || (*cursor == '\n') || (*cursor == '\r')) break;
+
+		ObjCorner c = { 0, 0, 0 };
+		c.v = (int)strtol(cursor, &cursor, 10);
+		if (*cursor == '/')
+		{
+			cursor++;
+			if (*cursor != '/') c.vt = (int)strtol(cursor, &cursor, 10);
+			if (*cursor == '/') { cursor++; c.vn = (int)strtol(cursor, &cursor, 10); }
+		}
+		if (c.v == 0) return false;
+		while ((*cursor != '\0') && (*cursor != ' ') && (*cursor != '\t') && (*cursor != '\n') && (*cursor != '\r')) cursor++;
+
+		c.v = (c.v < 0) ? positionCount + c.v : c.v - 1;
+		c.vt = (c.vt < 0) ? texcoordCount + c.vt : c.vt - 1;
+		c.vn = (c.vn < 0) ? normalCount + c.vn : c.vn - 1;
+		if ((c.v < 0) || (c.v >= positionCount)) return false;
+		if ((c.vt < 0) || (c.vt >= texcoordCount)) c.vt = -1;
+		if ((c.vn < 0) || (c.vn >= normalCount)) c.vn = -1;
+		face->push_back(c);
+	}
+	return true;
+}
+
+// OBJ reader: v, vt, vn, f (polygons are fanned into triangles), mtllib and usemtl.
+// Identical v/vt/vn corners share a vertex; V is flipped like raylib's LoadOBJ.
+static bool ReadOBJ(const char *fileName, MeshData *data)
+{
+	char *text = LoadFileText(fileName);
+	if (text == nullptr) return false;
+
+	const int cornerBits = 21;                  // Per index in the packed corner key
+	std::vector<float> positions, texcoords, normals;
+	std::vector<std::string> materialNames;
+	std::vector<ObjCorner> face;
+	std::unordered_map<unsigned long long, unsigned short> corners;   // Corner key -> vertex of the current part
+	int material = -1;
+	bool newPart = true;
+	bool ok = true;
+
+	*data = MeshData();
+	for (const char *p = text; ok && (*p != '\0');)
+	{
+		const char *line = p;
+		while ((*p != '\0') && (*p != '\n')) p++;
+		if (*p == '\n') p++;
+		while ((*line == ' ') || (*line == '\t')) line++;
+
+		if ((line[0] == 'v') && (line[1] == ' '))
+		{
+			char *end = (char *)line + 2;
+			for (int i = 0; i < 3; i++) positions.push_back(strtof(end, &end));
+		}
+		else if ((line[0] == 'v') && (line[1] == 't'))
+		{
+			char *end = (char *)line + 2;
+			for (int i = 0; i < 2; i++) texcoords.push_back(strtof(end, &end));
+		}
+		else if ((line[0] == 'v') && (line[1] == 'n'))
+		{
+			char *end = (char *)line + 2;
+			for (int i = 0; i < 3; i++) normals.push_back(strtof(end, &end));
+		}
+		else if (LineKeyword(line, "mtllib"))
+		{
+			ReadMTL((DirectoryOf(fileName) + LineArgument(line, "mtllib")).c_str(), &materialNames, &data->materialMaps);
+		}
+		else if (LineKeyword(line, "usemtl"))
+		{
+			int index = MaterialIndex(&materialNames, &data->materialMaps, LineArgument(line, "usemtl"));
+			if (index != material) { material = index; newPart = true; }
+		}
+		else if ((line[0] == 'f') && (line[1] == ' '))
+		{
+			int positionCount = (int)positions.size()/3;
+			int texcoordCount = (int)texcoords.size()/2;
+			int normalCount = (int)normals.size()/3;
+			ok = (positionCount < (1 << cornerBits)) && (texcoordCount < (1 << cornerBits)) && (normalCount < (1 << cornerBits)) &&
+				 ParseFace((char *)line + 2, positionCount, texcoordCount, normalCount, &face);
+
+			for (size_t k = 2; ok && (k < face.size()); k++)
+			{
+				if (newPart || (data->parts.back().positions.size()/3 + 3 > COOKED_PART_VERTICES))
+				{
+					data->parts.emplace_back();
+					data->parts.back().material = material;
+					corners.clear();
+					newPart = false;
+				}
+				MeshPart &part = data->parts.back();
+
+				const ObjCorner tri[3] = { face[0], face[k - 1], face[k] };
+				for (const ObjCorner &c : tri)
+				{
+					unsigned long long key = ((unsigned long long)c.v << (2*cornerBits)) | ((unsigned long long)(c.vt + 1) << cornerBits) | (unsigned long long)(c.vn + 1);
+					auto found = corners.find(key);
+					if (found != corners.end()) { part.indices.push_back(found->second); continue; }
+
+					unsigned short index = (unsigned short)(part.positions.size()/3);
+					corners.emplace(key, index);
+					part.indices.push_back(index);
+
+					for (int n = 0; n < 3; n++) part.positions.push_back(positions[c.v*3 + n]);
+					part.texcoords.push_back((c.vt >= 0) ? texcoords[c.vt*2] : 0.0f);
+					part.texcoords.push_back((c.vt >= 0) ? 1.0f - texcoords[c.vt*2 + 1] : 0.0f);
+					for (int n = 0; n < 3; n++) part.normals.push_back((c.vn >= 0) ? normals[c.vn*3 + n] : (n == 1 ? 1.0f : 0.0f));
+				}
+			}
+		}
+	}
+	UnloadFileText(text);
+
+	if (!ok || data->parts.empty())
+	{
+		*data = MeshData();
+		return false;
+	}
+
+	data->hasTexcoords = !texcoords.empty();
+	data->hasNormals = !normals.empty();
+	for (MeshPart &part : data->parts)
+	{
+		if (!data->hasTexcoords) part.texcoords.clear();
+		if (!data->hasNormals) part.normals.clear();
+
+		part.bounds.min = part.bounds.max = { part.positions[0], part.positions[1], part.positions[2] };
+		for (size_t i = 0; i < part.positions.size(); i += 3)
+		{
+			Vector3 v = { part.positions[i], part.positions[i + 1], part.positions[i + 2] };
+			part.bounds.min = Vector3Min(part.bounds.min, v);
+			part.bounds.max = Vector3Max(part.bounds.max, v);
+		}
+	}
+	return true;
+}
+
+// Writes the cooked version of an OBJ file
+static bool CookMesh(const char *sourceFile, const char *cookedFile)
+{
+	MeshData data;
+	if (!ReadOBJ(sourceFile, &data))
+	{
+		TraceLog(LOG_WARNING, "COOK: [%s] Failed to read OBJ", sourceFile);
+		return false;
+	}
+
+	const size_t partTable = sizeof(CookedHeader);
+	const size_t materialTable = partTable + data.parts.size()*sizeof(CookedPart);
+	std::vector<unsigned char> bytes(materialTable + data.materialMaps.size()*sizeof(unsigned long long));
+
+	auto append = [&bytes](const void *source, size_t size) -> unsigned long long {
+		size_t offset = (bytes.size() + COOKED_MESH_ALIGN - 1) & ~(size_t)(COOKED_MESH_ALIGN - 1);
+		bytes.resize(offset + size);
+		memcpy(bytes.data() + offset, source, size);
+		return offset;
+	};
+
+	CookedHeader header = { { 'A', 'M', 'S', 'H' }, COOKED_MESH_VERSION };
+	header.sourceSize = GetFileLength(sourceFile);
+	header.sourceModTime = GetFileModTime(sourceFile);
+	header.partCount = (unsigned int)data.parts.size();
+	header.materialCount = (unsigned int)data.materialMaps.size();
+	header.streams = (data.hasTexcoords ? COOKED_STREAM_TEXCOORDS : 0) | (data.hasNormals ? COOKED_STREAM_NORMALS : 0);
+
+	int vertexCount = 0;
+	int triangleCount = 0;
+	for (size_t i = 0; i < data.parts.size(); i++)
+	{
+		const MeshPart &source = data.parts[i];
+		CookedPart part = { 0 };
+		part.vertexCount = (unsigned int)source.positions.size()/3;
+		part.indexCount = (unsigned int)source.indices.size();
+		part.material = source.material;
+		memcpy(part.boundsMin, &source.bounds.min, sizeof(part.boundsMin));
+		memcpy(part.boundsMax, &source.bounds.max, sizeof(part.boundsMax));
+		part.positions = append(source.positions.data(), source.positions.size()*sizeof(float));
+		if (data.hasTexcoords) part.texcoords = append(source.texcoords.data(), source.texcoords.size()*sizeof(float));
+		if (data.hasNormals) part.normals = append(source.normals.data(), source.normals.size()*sizeof(float));
+		part.indices = append(source.indices.data(), source.indices.size()*sizeof(unsigned short));
+		memcpy(bytes.data() + partTable + i*sizeof(CookedPart), &part, sizeof(part));
+
+		vertexCount += (int)part.vertexCount;
+		triangleCount += (int)part.indexCount/3;
+	}
+
+	for (size_t i = 0; i < data.materialMaps.size(); i++)
+	{
+		const std::string &map = data.materialMaps[i];
+		unsigned long long offset = map.empty() ? 0 : append(map.c_str(), map.size() + 1);
+		memcpy(bytes.data() + materialTable + i*sizeof(offset), &offset, sizeof(offset));
+	}
+	memcpy(bytes.data(), &header, sizeof(header));
+
+	if (!SaveFileData(cookedFile, bytes.data(), (int)bytes.size())) return false;
+	TraceLog(LOG_INFO, "COOK: [%s] %i parts, %i vertices, %i triangles, %i materials", cookedFile,
+			 (int)header.partCount, vertexCount, triangleCount, (int)header.materialCount);
+	return true;
+}
+
+#if defined(_WIN32)
+// Declared here rather than including windows.h, whose names clash with raylib's
+extern "C" {
+	__declspec(dllimport) void *__stdcall CreateFileA(const char *, unsigned long, unsigned long, void *, unsigned long, unsigned long, void *);
+	__declspec(dllimport) void *__stdcall CreateFileMappingA(void *, void *, unsigned long, unsigned long, unsigned long, const char *);
+	__declspec(dllimport) void *__stdcall MapViewOfFile(void *, unsigned long, unsigned long, unsigned long, size_t);
+	__declspec(dllimport) int __stdcall UnmapViewOfFile(const void *);
+	__declspec(dllimport) int __stdcall GetFileSizeEx(void *, long long *);
+	__declspec(dllimport) int __stdcall CloseHandle(void *);
+	__declspec(dllimport) int __stdcall CreateDirectoryA(const char *, void *);
+}
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+	~MappedFile() { Close(); }
+
+	bool Open(const char *fileName)
+	{
+		Close();
+#if defined(_WIN32)
+		void *invalid = (void *)(intptr_t)-1;
+		file = CreateFileA(fileName, 0x80000000 /*GENERIC_READ*/, 1 /*FILE_SHARE_READ*/, nullptr, 3 /*OPEN_EXISTING*/, 0x80 /*FILE_ATTRIBUTE_NORMAL*/, nullptr);
+		if (file == invalid) { file = nullptr; return false; }
+		long long length = 0;
+		if (GetFileSizeEx(file, &length) && (length > 0)) mapping = CreateFileMappingA(file, nullptr, 2 /*PAGE_READONLY*/, 0, 0, nullptr);
+		if (mapping != nullptr) data = (const unsigned char *)MapViewOfFile(mapping, 4 /*FILE_MAP_READ*/, 0, 0, 0);
+		if (data == nullptr) { Close(); return false; }
+		size = (size_t)length;
+#else
+		int fd = open(fileName, O_RDONLY);
+		if (fd < 0) return false;
+		struct stat info;
+		if ((fstat(fd, &info) == 0) && (info.st_size > 0))
+		{
+			void *address = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (address != MAP_FAILED) { data = (const unsigned char *)address; size = (size_t)info.st_size; }
+		}
+		close(fd);          // The mapping keeps the file open
+		if (data == nullptr) return false;
+#endif
+		return true;
+	}
+
+	void Close()
+	{
+#if defined(_WIN32)
+		if (data != nullptr) UnmapViewOfFile(data);
+		if (mapping != nullptr) CloseHandle(mapping);
+		if (file != nullptr) CloseHandle(file);
+		mapping = file = nullptr;
+#else
+		if (data != nullptr) munmap((void *)data, size);
+#endif
+		data = nullptr;
+		size = 0;
+	}
+
+	// Reads one byte per page, so later accesses do not wait for the disk
+	void Prefault() const
+	{
+		volatile unsigned char sink = 0;
+		for (size_t i = 0; i < size; i += 4096) sink = sink ^ data[i];
+	}
+
+	const unsigned char *Data() const { return data; }
+	size_t Size() const { return size; }
+
+private:
+	const unsigned char *data = nullptr;
+	size_t size = 0;
+#if defined(_WIN32)
+	void *file = nullptr;
+	void *mapping = nullptr;
+#endif
+};
+
+struct CookedMesh
+{
+	MappedFile file;
+	const CookedHeader *header = nullptr;       // Into the mapping, null if not open
+	const CookedPart *parts = nullptr;
+	const unsigned long long *materials = nullptr;
+};
+
+// Maps a cooked file after checking it is complete and up to date with its source;
+// if the source is missing (shipped without it) the cooked file is used as is
+static bool OpenCookedMesh(const char *cookedFile, const char *sourceFile, CookedMesh *cooked)
+{
+	cooked->header = nullptr;
+	if (!FileExists(cookedFile) || !cooked->file.Open(cookedFile)) return false;
+
+	const unsigned char *data = cooked->file.Data();
+	const size_t size = cooked->file.Size();
+	auto inside = [size](unsigned long long offset, unsigned long long length) {
+		return (offset <= size) && (length <= size - offset);
+	};
+	auto stream = [&inside](unsigned long long offset, unsigned long long length) {
+		return (offset%COOKED_MESH_ALIGN == 0) && inside(offset, length);
+	};
+
+	const CookedHeader *header = (const CookedHeader *)data;
+	const char *problem = nullptr;
+	if ((size < sizeof(CookedHeader)) || (memcmp(header->magic, "AMSH", 4) != 0)) problem = "not a cooked mesh";
+	else if (header->version != COOKED_MESH_VERSION) problem = "old version";
+	else if (FileExists(sourceFile) && ((GetFileLength(sourceFile) != header->sourceSize) || (GetFileModTime(sourceFile) != header->sourceModTime))) problem = "source changed";
+	else if ((header->partCount == 0) || !inside(sizeof(CookedHeader), (unsigned long long)header->partCount*sizeof(CookedPart) + (unsigned long long)header->materialCount*sizeof(unsigned long long))) problem = "truncated";
+
+	const CookedPart *parts = (const CookedPart *)(data + sizeof(CookedHeader));
+	const unsigned long long *materials = (const unsigned long long *)(parts + (problem ? 0 : header->partCount));
+	for (unsigned int i = 0; !problem && (i < header->partCount); i++)
+	{
+		const CookedPart &part = parts[i];
+		unsigned long long vertexCount = part.vertexCount;
+		bool valid = (vertexCount > 0) && (vertexCount <= COOKED_PART_VERTICES) && (part.indexCount%3 == 0) &&
+					 (part.material >= -1) && (part.material < (int)header->materialCount) &&
+					 stream(part.positions, vertexCount*3*sizeof(float)) && stream(part.indices, part.indexCount*sizeof(unsigned short)) &&
+					 (!(header->streams & COOKED_STREAM_TEXCOORDS) || stream(part.texcoords, vertexCount*2*sizeof(float))) &&
+					 (!(header->streams & COOKED_STREAM_NORMALS) || stream(part.normals, vertexCount*3*sizeof(float)));
+		if (!valid) problem = "corrupt part table";
+	}
+	for (unsigned int i = 0; !problem && (i < header->materialCount); i++)
+	{
+		if ((materials[i] != 0) && ((materials[i] >= size) || (memchr(data + materials[i], '\0', size - materials[i]) == nullptr))) problem = "corrupt material table";
+	}
+
+	if (problem != nullptr)
+	{
+		TraceLog(LOG_WARNING, "COOK: [%s] Ignored (%s), loading %s instead", cookedFile, problem, sourceFile);
+		cooked->file.Close();
+		return false;
+	}
+
+	cooked->header = header;
+	cooked->parts = parts;
+	cooked->materials = materials;
+	return true;
+}
+
+// Model with one default material per material reference (at least one)
+static Model AllocModel(int meshCount, int materialCount)
+{
+	Model model = { 0 };
+	model.transform = MatrixIdentity();
+	model.meshCount = meshCount;
+	model.meshes = (Mesh *)MemAlloc(meshCount*sizeof(Mesh));
+	model.meshMaterial = (int *)MemAlloc(meshCount*sizeof(int));
+	model.materialCount = (materialCount > 0) ? materialCount : 1;
+	model.materials = (Material *)MemAlloc(model.materialCount*sizeof(Material));
+	for (int i = 0; i < model.materialCount; i++) model.materials[i] = LoadMaterialDefault();
+	return model;
+}
+
+// Diffuse maps are loaded like LoadOBJ() does, relative to the source file
+static void LoadMaterialMap(Model *model, int material, const char *sourceFile, const char *map)
+{
+	if ((map == nullptr) || (map[0] == '\0')) return;
+	model->materials[material].maps[MATERIAL_MAP_DIFFUSE].texture = LoadTexture((DirectoryOf(sourceFile) + map).c_str());
+}
+
+template <typename T>
+static T *MemCopy(const std::vector<T> &values)
+{
+	if (values.empty()) return nullptr;
+	T *copy = (T *)MemAlloc((unsigned int)(values.size()*sizeof(T)));
+	memcpy(copy, values.data(), values.size()*sizeof(T));
+	return copy;
+}
+
+// Main thread: uploads parsed OBJ data; the model owns copies and unloads with UnloadModel()
+static Model UploadMeshData(const MeshData &data, const char *sourceFile)
+{
+	Model model = AllocModel((int)data.parts.size(), (int)data.materialMaps.size());
+	for (int i = 0; i < model.meshCount; i++)
+	{
+		const MeshPart &part = data.parts[i];
+		Mesh &mesh = model.meshes[i];
+		mesh.vertexCount = (int)part.positions.size()/3;
+		mesh.triangleCount = (int)part.indices.size()/3;
+		mesh.vertices = MemCopy(part.positions);
+		mesh.texcoords = MemCopy(part.texcoords);
+		mesh.normals = MemCopy(part.normals);
+		mesh.indices = MemCopy(part.indices);
+		UploadMesh(&mesh, false);
+		model.meshMaterial[i] = (part.material >= 0) ? part.material : 0;
+	}
+	for (size_t i = 0; i < data.materialMaps.size(); i++) LoadMaterialMap(&model, (int)i, sourceFile, data.materialMaps[i].c_str());
+	return model;
+}
+
+// Main thread: uploads the streams straight from the mapping. The meshes keep
+// pointing into it (read-only), so the model must be unloaded with
+// UnloadCookedModel() before the cooked mesh is closed.
+static Model UploadCookedMesh(const CookedMesh &cooked, const char *sourceFile)
+{
+	const unsigned char *data = cooked.file.Data();
+	Model model = AllocModel((int)cooked.header->partCount, (int)cooked.header->materialCount);
+	for (int i = 0; i < model.meshCount; i++)
+	{
+		const CookedPart &part = cooked.parts[i];
+		Mesh &mesh = model.meshes[i];
+		mesh.vertexCount = (int)part.vertexCount;
+		mesh.triangleCount = (int)part.indexCount/3;
+		mesh.vertices = (float *)(data + part.positions);
+		if (cooked.header->streams & COOKED_STREAM_TEXCOORDS) mesh.texcoords = (float *)(data + part.texcoords);
+		if (cooked.header->streams & COOKED_STREAM_NORMALS) mesh.normals = (float *)(data + part.normals);
+		mesh.indices = (unsigned short *)(data + part.indices);
+		UploadMesh(&mesh, false);
+		model.meshMaterial[i] = (part.material >= 0) ? part.material : 0;
+	}
+	for (unsigned int i = 0; i < cooked.header->materialCount; i++)
+	{
+		if (cooked.materials[i] != 0) LoadMaterialMap(&model, (int)i, sourceFile, (const char *)(data + cooked.materials[i]));
+	}
+	return model;
+}
+
+static void UnloadCookedModel(Model model)
+{
+	// The vertex data belongs to the mapping, not to raylib's allocator
+	for (int i = 0; i < model.meshCount; i++)
+	{
+		Mesh &mesh = model.meshes[i];
+		mesh.vertices = mesh.texcoords = mesh.normals = nullptr;
+		mesh.indices = nullptr;
+	}
+	UnloadModel(model);
+}
+
+//----------------------------------------------------------------------------------
+// Compressed textures
+// CompressTextures writes name.dds (BC1/BC3 with the whole mip chain) next to
+// name.png. raylib's DDS reader keeps only the first level of compressed files,
+// so the header is read here.
+//----------------------------------------------------------------------------------
+#define DDS_HEADER_SIZE         128         // "DDS " and the 124 byte header
+
+// Loads the .dds next to an image if it is at least as new as the image.
+// The image owns the file buffer, with the header moved out of the way.
+static bool LoadCompressedImage(const char *fileName, Image *image)
+{
+	std::string ddsFile = fileName;
+	ddsFile.resize(ddsFile.size() - strlen(GetFileExtension(fileName)));
+	ddsFile += ".dds";
+	if (!FileExists(ddsFile.c_str())) return false;
+	if (FileExists(fileName) && (GetFileModTime(ddsFile.c_str()) < GetFileModTime(fileName))) return false;
+
+	int size = 0;
+	unsigned char *data = LoadFileData(ddsFile.c_str(), &size);
+	if (data == nullptr) return false;
+	unsigned int field[32] = { 0 };
+	if (size >= DDS_HEADER_SIZE) memcpy(field, data, sizeof(field));
+
+	// field[3]: height, [4]: width, [7]: mip count, [21]: fourcc
+	Image result = { data, (int)field[4], (int)field[3], (field[7] > 0) ? (int)field[7] : 1, 0 };
+	if (field[21] == 0x31545844) result.format = PIXELFORMAT_COMPRESSED_DXT1_RGB;          // "DXT1"
+	else if (field[21] == 0x35545844) result.format = PIXELFORMAT_COMPRESSED_DXT5_RGBA;    // "DXT5"
+
+	int payload = 0;
+	for (int i = 0, w = result.width, h = result.height; (result.format != 0) && (i < result.mipmaps); i++)
+	{
+		payload += GetPixelDataSize(w, h, result.format);
+		w = (w > 1) ? w/2 : 1;
+		h = (h > 1) ? h/2 : 1;
+	}
+	if ((memcmp(data, "DDS ", 4) != 0) || (result.format == 0) || (result.width <= 0) || (result.height <= 0) || (payload > size - DDS_HEADER_SIZE))
+	{
+		UnloadFileData(data);
+		return false;
+	}
+
+	memmove(data, data + DDS_HEADER_SIZE, payload);
+	*image = result;
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Visibility
+// The scene is a list of model instances with a bounding volume hierarchy over
+// their world bounds. Each frame the camera frustum is tested against the tree:
+// subtrees fully inside are accepted without further tests, instances in
+// partially visible nodes have each mesh's bounds tested, and only meshes that
+// pass are drawn.
+//----------------------------------------------------------------------------------
+#define BVH_LEAF_INSTANCES      4
+#define BVH_MAX_DEPTH           64
+
+// Planes as (a, b, c, d) with a*x + b*y + c*z + d >= 0 on the inside
+typedef struct Frustum {
+	Vector4 planes[6];
+} Frustum;
+
+typedef enum {
+	CULL_OUTSIDE = 0,
+	CULL_INTERSECTS,
+	CULL_INSIDE
+} CullResult;
+
+// Per frame counters
+typedef struct CullStats {
+	int nodesTested;            // BVH nodes tested against the frustum
+	int meshesTested;           // Mesh bounds tested (meshes of fully visible instances are not)
+	int meshesVisible;          // Meshes inside or crossing the frustum
+	int meshesSubmitted;        // DrawMesh() calls
+	int meshesTotal;
+} CullStats;
+
+// Same projection as BeginMode3D(), so the planes match what is drawn
+static Frustum GetCameraFrustum(Camera camera, float aspect)
+{
+	Matrix projection = { 0 };
+	if (camera.projection == CAMERA_ORTHOGRAPHIC)
+	{
+		double top = camera.fovy/2.0;
+		projection = MatrixOrtho(-top*aspect, top*aspect, -top, top, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+	}
+	else projection = MatrixPerspective(camera.fovy*DEG2RAD, aspect, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+
+	// Rows of the combined clip matrix give the planes (Gribb/Hartmann)
+	Matrix m = MatrixMultiply(GetCameraMatrix(camera), projection);
+	Vector4 rowX = { m.m0, m.m4, m.m8, m.m12 };
+	Vector4 rowY = { m.m1, m.m5, m.m9, m.m13 };
+	Vector4 rowZ = { m.m2, m.m6, m.m10, m.m14 };
+	Vector4 rowW = { m.m3, m.m7, m.m11, m.m15 };
+
+	// Left, right, bottom, top, near, far: w + axis or w - axis
+	const Vector4 axes[3] = { rowX, rowY, rowZ };
+	Frustum frustum = { 0 };
+	for (int i = 0; i < 6; i++)
+	{
+		float sign = (i%2 == 0) ? 1.0f : -1.0f;
+		const Vector4 &axis = axes[i/2];
+		Vector4 p = { rowW.x + sign*axis.x, rowW.y + sign*axis.y, rowW.z + sign*axis.z, rowW.w + sign*axis.w };
+		float length = sqrtf(p.x*p.x + p.y*p.y + p.z*p.z);
+		if (length > 0.0f) p = { p.x/length, p.y/length, p.z/length, p.w/length };
+		frustum.planes[i] = p;
+	}
+	return frustum;
+}
+
+static CullResult FrustumTestBox(const Frustum *frustum, BoundingBox box)
+{
+	CullResult result = CULL_INSIDE;
+	for (int i = 0; i < 6; i++)
+	{
+		Vector4 p = frustum->planes[i];
+
+		// Corner furthest along the plane normal, then the one furthest against it
+		float outer = p.x*((p.x >= 0.0f) ? box.max.x : box.min.x) + p.y*((p.y >= 0.0f) ? box.max.y : box.min.y) + p.z*((p.z >= 0.0f) ? box.max.z : box.min.z) + p.w;
+		if (outer < 0.0f) return CULL_OUTSIDE;
+		float inner = p.x*((p.x >= 0.0f) ? box.min.x : box.max.x) + p.y*((p.y >= 0.0f) ? box.min.y : box.max.y) + p.z*((p.z >= 0.0f) ? box.min.z : box.max.z) + p.w;
+		if (inner < 0.0f) result = CULL_INTERSECTS;
+	}
+	return result;
+}
+
+// Axis aligned box around a transformed box
+static BoundingBox TransformBoundingBox(BoundingBox box, Matrix m)
+{
+	Vector3 center = Vector3Transform(Vector3Scale(Vector3Add(box.min, box.max), 0.5f), m);
+	Vector3 extent = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+	Vector3 rotated = {
+		fabsf(m.m0)*extent.x + fabsf(m.m4)*extent.y + fabsf(m.m8)*extent.z,
+		fabsf(m.m1)*extent.x + fabsf(m.m5)*extent.y + fabsf(m.m9)*extent.z,
+		fabsf(m.m2)*extent.x + fabsf(m.m6)*extent.y + fabsf(m.m10)*extent.z
+	};
+	return BoundingBox{ Vector3Subtract(center, rotated), Vector3Add(center, rotated) };
+}
+
+static BoundingBox MergeBoundingBox(BoundingBox a, BoundingBox b)
+{
+	return BoundingBox{ Vector3Min(a.min, b.min), Vector3Max(a.max, b.max) };
+}
+
+// Static tree over instance bounds, split at the median centroid of the longest
+// axis. Nodes are stored depth first, so a node's left child follows it, and
+// every node covers a contiguous range of the instance order.
+class SceneBVH
+{
+public:
+	void Build(const std::vector<BoundingBox> &bounds)
+	{
+		nodes.clear();
+		order.resize(bounds.size());
+		for (size_t i = 0; i < order.size(); i++) order[i] = (int)i;
+		if (!bounds.empty()) BuildNode(bounds, 0, (int)bounds.size(), 0);
+	}
+
+	// Calls visit(instance, inside) for each instance whose node is not outside the
+	// frustum; 'inside' is true when the node is entirely inside it
+	template <typename Visit>
+	void Query(const Frustum &frustum, CullStats *stats, Visit visit) const
+	{
+		if (nodes.empty()) return;
+		int stack[BVH_MAX_DEPTH + 1];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0)
+		{
+			const Node &node = nodes[stack[--top]];
+			stats->nodesTested++;
+			CullResult result = FrustumTestBox(&frustum, node.bounds);
+			if (result == CULL_OUTSIDE) continue;
+
+			if ((result == CULL_INSIDE) || (node.right < 0))
+			{
+				for (int i = node.first; i < node.first + node.count; i++) visit(order[i], result == CULL_INSIDE);
+			}
+			else
+			{
+				stack[top++] = node.right;
+				stack[top++] = (int)(&node - nodes.data()) + 1;
+			}
+		}
+	}
+
+	int NodeCount() const { return (int)nodes.size(); }
+
+private:
+	struct Node
+	{
+		BoundingBox bounds;
+		int first;              // Range in 'order'
+		int count;
+		int right;              // Right child, -1 for a leaf
+	};
+
+	int BuildNode(const std::vector<BoundingBox> &bounds, int first, int count, int depth)
+	{
+		int index = (int)nodes.size();
+		nodes.push_back(Node{ bounds[order[first]], first, count, -1 });
+
+		BoundingBox centers = { Vector3Scale(Vector3Add(bounds[order[first]].min, bounds[order[first]].max), 0.5f), { 0 } };
+		centers.max = centers.min;
+		for (int i = first; i < first + count; i++)
+		{
+			const BoundingBox &box = bounds[order[i]];
+			nodes[index].bounds = MergeBoundingBox(nodes[index].bounds, box);
+			Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+			centers.min = Vector3Min(centers.min, center);
+			centers.max = Vector3Max(centers.max, center);
+		}
+		if ((count <= BVH_LEAF_INSTANCES) || (depth >= BVH_MAX_DEPTH - 1)) return index;
+
+		Vector3 size = Vector3Subtract(centers.max, centers.min);
+		int axis = ((size.x >= size.y) && (size.x >= size.z)) ? 0 : ((size.y >= size.z) ? 1 : 2);
+		auto center = [&bounds, axis](int i) {
+			const BoundingBox &box = bounds[i];
+			return (axis == 0) ? box.min.x + box.max.x : ((axis == 1) ? box.min.y + box.max.y : box.min.z + box.max.z);
+		};
+		int half = count/2;
+		std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+						 [&center](int a, int b) { return center(a) < center(b); });
+
+		BuildNode(bounds, first, half, depth + 1);
+		int right = BuildNode(bounds, first + half, count - half, depth + 1);
+		nodes[index].right = right;
+		return index;
+	}
+
+	std::vector<Node> nodes;
+	std::vector<int> order;
+};
+
+// A model placed in the world; 'model' is a slot in the caller's model table
+typedef struct SceneInstance {
+	int model;
+	Matrix transform;
+	BoundingBox bounds;         // World space, around all of the model's meshes
+} SceneInstance;
+
+// Draws a model's meshes, skipping those outside the frustum; pass a null
+// frustum for an instance already known to be entirely visible
+static void DrawModelCulled(const Model &model, const std::vector<BoundingBox> &meshBounds, Matrix transform, const Frustum *frustum, CullStats *stats)
+{
+	Matrix world = MatrixMultiply(model.transform, transform);
+	for (int i = 0; i < model.meshCount; i++)
+	{
+		if ((frustum != nullptr) && (i < (int)meshBounds.size()))
+		{
+			stats->meshesTested++;
+			if (FrustumTestBox(frustum, TransformBoundingBox(meshBounds[i], world)) == CULL_OUTSIDE) continue;
+		}
+		stats->meshesVisible++;
+		DrawMesh(model.meshes[i], model.materials[model.meshMaterial[i]], world);
+		stats->meshesSubmitted++;
+	}
+}
+
+//----------------------------------------------------------------------------------
+// Clustered lighting
+// rlights.h sends five uniforms per light every frame and the shader loops over
+// a fixed array of four. Here any number of lights (up to LIGHTS_MAX) is packed
+// in a float texture that is only uploaded when a light changes. The view
+// frustum is split in clusters, screen tiles by exponential depth slices, and
+// every cluster lists the point lights whose sphere reaches it, so
+// lighting_clustered.fs visits only the lights near each fragment.
+//----------------------------------------------------------------------------------
+#define LIGHTS_MAX              1024        // Rows of the light data texture
+#define LIGHT_DATA_TEXELS       3           // (position, radius), (color, type), (direction, 0)
+#define LIGHT_CLUSTERS_X        16
+#define LIGHT_CLUSTERS_Y        9
+#define LIGHT_CLUSTERS_Z        24
+#define LIGHT_CLUSTER_NEAR      0.5f        // Slice 0 ends here, the last one at RL_CULL_DISTANCE_FAR
+#define LIGHT_INDEX_WIDTH       1024        // Must match lighting_clustered.fs
+#define LIGHT_INDEX_ROWS        64
+
+typedef struct SceneLight {
+	int type;                   // LightType
+	bool enabled;
+	Vector3 position;
+	Vector3 target;             // Directional lights shine from position towards target
+	Color color;
+	float radius;               // Point lights do not reach beyond this
+} SceneLight;
+
+// Per frame counters
+typedef struct LightStats {
+	int lightsPacked;           // Enabled lights in the data texture
+	int clusterIndices;         // Entries in the cluster light lists
+	int maxClusterLights;       // Longest list of a single cluster
+	int droppedIndices;         // Entries that did not fit in the index texture
+	int dataUploads;            // Light data uploads since Init()
+	int clusterUploads;         // Cluster grid uploads since Init()
+} LightStats;
+
+class LightManager
+{
+public:
+	// The shader must be lighting_clustered.fs (or declare the same uniforms)
+	void Init(Shader shader)
+	{
+		dataTexture = LoadDataTexture(LIGHT_DATA_TEXELS, LIGHTS_MAX, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32);
+		gridTexture = LoadDataTexture(LIGHT_CLUSTERS_X*LIGHT_CLUSTERS_Y, LIGHT_CLUSTERS_Z, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32);
+		indexTexture = LoadDataTexture(LIGHT_INDEX_WIDTH, LIGHT_INDEX_ROWS, PIXELFORMAT_UNCOMPRESSED_R32);
+		lights.clear();
+		stats = { 0 };
+		SetShader(shader);
+	}
+
+	// Also for a reloaded shader: locations and uniforms start over, the lights stay
+	void SetShader(Shader shader)
+	{
+		this->shader = shader;
+		lightCountLoc = GetShaderLocation(shader, "lightCount");
+		directionalCountLoc = GetShaderLocation(shader, "directionalCount");
+		clusteredLoc = GetShaderLocation(shader, "clustered");
+		clusterCountLoc = GetShaderLocation(shader, "clusterCount");
+		clusterTileSizeLoc = GetShaderLocation(shader, "clusterTileSize");
+		viewDepthLoc = GetShaderLocation(shader, "viewDepth");
+		clusterDepthLoc = GetShaderLocation(shader, "clusterDepth");
+
+		// DrawMesh() binds material maps to the sampler locations of their slots
+		this->shader.locs[SHADER_LOC_MAP_OCCLUSION] = GetShaderLocation(shader, "lightData");
+		this->shader.locs[SHADER_LOC_MAP_EMISSION] = GetShaderLocation(shader, "lightGrid");
+		this->shader.locs[SHADER_LOC_MAP_HEIGHT] = GetShaderLocation(shader, "lightIndices");
+
+		int clusterCount[3] = { LIGHT_CLUSTERS_X, LIGHT_CLUSTERS_Y, LIGHT_CLUSTERS_Z };
+		SetShaderValue(shader, clusterCountLoc, clusterCount, SHADER_UNIFORM_IVEC3);
+		float clusterDepth[2] = { LIGHT_CLUSTERS_Z/logf(RL_CULL_DISTANCE_FAR/LIGHT_CLUSTER_NEAR), 0.0f };
+		clusterDepth[1] = -logf(LIGHT_CLUSTER_NEAR)*clusterDepth[0];
+		SetShaderValue(shader, clusterDepthLoc, clusterDepth, SHADER_UNIFORM_VEC2);
+		SetClustered(clustered);
+		dataDirty = true;
+	}
+
+	void Unload()
+	{
+		if (dataTexture.id != 0) UnloadTexture(dataTexture);
+		if (gridTexture.id != 0) UnloadTexture(gridTexture);
+		if (indexTexture.id != 0) UnloadTexture(indexTexture);
+		dataTexture = gridTexture = indexTexture = Texture2D{ 0 };
+		lights.clear();
+	}
+
+	// Returns the light's id, or -1 if LIGHTS_MAX lights exist already
+	int Add(int type, Vector3 position, Vector3 target, Color color, float radius)
+	{
+		if ((int)lights.size() >= LIGHTS_MAX) return -1;
+		lights.push_back({ type, true, position, target, color, radius });
+		dataDirty = true;
+		return (int)lights.size() - 1;
+	}
+
+	// Removes the lights from 'count' on
+	void Truncate(int count)
+	{
+		if (count >= (int)lights.size()) return;
+		lights.resize(count);
+		dataDirty = true;
+	}
+
+	int Count() const { return (int)lights.size(); }
+	const SceneLight &Get(int id) const { return lights[id]; }
+
+	// Write access marks the light data for upload
+	SceneLight &Edit(int id) { dataDirty = true; return lights[id]; }
+
+	// Off: every fragment loops over all lights, for comparison
+	void SetClustered(bool clustered)
+	{
+		this->clustered = clustered;
+		int value = clustered ? 1 : 0;
+		SetShaderValue(shader, clusteredLoc, &value, SHADER_UNIFORM_INT);
+		lastWidth = 0;
+	}
+	bool IsClustered() const { return clustered; }
+
+	// Before drawing: uploads the light data if it changed and, when the lights,
+	// the camera or the render size changed, reassigns point lights to clusters
+	void Update(Camera camera, int width, int height)
+	{
+		bool viewChanged = (memcmp(&camera, &lastCamera, sizeof(Camera)) != 0) || (width != lastWidth) || (height != lastHeight);
+		if (!dataDirty && !viewChanged) return;
+
+		if (dataDirty) PackLights();
+
+		Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+		float viewDepth[4] = { forward.x, forward.y, forward.z, -Vector3DotProduct(forward, camera.position) };
+		SetShaderValue(shader, viewDepthLoc, viewDepth, SHADER_UNIFORM_VEC4);
+		float tileSize[2] = { (float)width/LIGHT_CLUSTERS_X, (float)height/LIGHT_CLUSTERS_Y };
+		SetShaderValue(shader, clusterTileSizeLoc, tileSize, SHADER_UNIFORM_VEC2);
+
+		if (clustered) AssignClusters(camera, (float)width/(float)height);
+
+		lastCamera = camera;
+		lastWidth = width;
+		lastHeight = height;
+		dataDirty = false;
+	}
+
+	// Points a material's spare map slots at the light textures
+	void Bind(Material *material) const
+	{
+		material->shader = shader;
+		material->maps[MATERIAL_MAP_OCCLUSION].texture = dataTexture;
+		material->maps[MATERIAL_MAP_EMISSION].texture = gridTexture;
+		material->maps[MATERIAL_MAP_HEIGHT].texture = indexTexture;
+	}
+
+	Shader GetShader() const { return shader; }
+	const LightStats &GetStats() const { return stats; }
+
+private:
+	struct ClusterRange { int x0, x1, y0, y1, z0, z1; };       // Inclusive, empty if x1 < x0
+
+	static Texture2D LoadDataTexture(int width, int height, int format)
+	{
+		Texture2D texture = { 0 };
+		texture.id = rlLoadTexture(nullptr, width, height, format, 1);
+		texture.width = width;
+		texture.height = height;
+		texture.mipmaps = 1;
+		texture.format = format;
+		SetTextureFilter(texture, TEXTURE_FILTER_POINT);
+		return texture;
+	}
+
+	// Directional lights first, then point lights; disabled lights are left out
+	void PackLights()
+	{
+		packed.clear();
+		points.clear();
+		int directionalCount = 0;
+		for (int pass = 0; pass < 2; pass++)
+		{
+			for (const SceneLight &light : lights)
+			{
+				if (!light.enabled || ((light.type == LIGHT_DIRECTIONAL) != (pass == 0))) continue;
+
+				Vector3 direction = Vector3Normalize(Vector3Subtract(light.target, light.position));
+				const float texels[LIGHT_DATA_TEXELS*4] = {
+					light.position.x, light.position.y, light.position.z, light.radius,
+					light.color.r/255.0f, light.color.g/255.0f, light.color.b/255.0f, (float)light.type,
+					direction.x, direction.y, direction.z, 0.0f
+				};
+				packed.insert(packed.end(), texels, texels + LIGHT_DATA_TEXELS*4);
+				if (pass == 0) directionalCount++;
+				else points.push_back(light);
+			}
+		}
+
+		int count = (int)packed.size()/(LIGHT_DATA_TEXELS*4);
+		if (count > 0) rlUpdateTexture(dataTexture.id, 0, 0, LIGHT_DATA_TEXELS, count, dataTexture.format, packed.data());
+		SetShaderValue(shader, lightCountLoc, &count, SHADER_UNIFORM_INT);
+		SetShaderValue(shader, directionalCountLoc, &directionalCount, SHADER_UNIFORM_INT);
+
+		firstPoint = directionalCount;
+		stats.lightsPacked = count;
+		stats.dataUploads++;
+	}
+
+	// Each point light covers the clusters inside the screen rectangle and the
+	// depth range of its sphere's view space box: conservative, never too few
+	void AssignClusters(Camera camera, float aspect)
+	{
+		const int tiles = LIGHT_CLUSTERS_X*LIGHT_CLUSTERS_Y;
+		Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+		Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
+		Vector3 up = Vector3CrossProduct(right, forward);
+		float tanY = tanf(camera.fovy*0.5f*DEG2RAD);
+		float depthScale = LIGHT_CLUSTERS_Z/logf(RL_CULL_DISTANCE_FAR/LIGHT_CLUSTER_NEAR);
+
+		// Cluster range of every light, then counts, offsets and the lists
+		ranges.clear();
+		counts.assign(tiles*LIGHT_CLUSTERS_Z, 0);
+		for (const SceneLight &light : points)
+		{
+			Vector3 offset = Vector3Subtract(light.position, camera.position);
+			Vector3 view = { Vector3DotProduct(offset, right), Vector3DotProduct(offset, up), Vector3DotProduct(offset, forward) };
+			float nearZ = view.z - light.radius;
+			float farZ = view.z + light.radius;
+			if (farZ <= 0.0f) { ranges.push_back({ 0, -1, 0, -1, 0, -1 }); continue; }
+
+			ClusterRange range = { 0, LIGHT_CLUSTERS_X - 1, 0, LIGHT_CLUSTERS_Y - 1, 0, LIGHT_CLUSTERS_Z - 1 };
+			if ((camera.projection == CAMERA_PERSPECTIVE) && (nearZ > RL_CULL_DISTANCE_NEAR))
+			{
+				// x/z over the box is extreme at its nearest or farthest depth
+				float kx = 1.0f/(tanY*aspect);
+				float ky = 1.0f/tanY;
+				float minX = fminf((view.x - light.radius)/nearZ, (view.x - light.radius)/farZ)*kx;
+				float maxX = fmaxf((view.x + light.radius)/nearZ, (view.x + light.radius)/farZ)*kx;
+				float minY = fminf((view.y - light.radius)/nearZ, (view.y - light.radius)/farZ)*ky;
+				float maxY = fmaxf((view.y + light.radius)/nearZ, (view.y + light.radius)/farZ)*ky;
+				if ((minX > 1.0f) || (maxX < -1.0f) || (minY > 1.0f) || (maxY < -1.0f)) { ranges.push_back({ 0, -1, 0, -1, 0, -1 }); continue; }
+
+				range.x0 = Clamp((int)floorf((minX*0.5f + 0.5f)*LIGHT_CLUSTERS_X), 0, LIGHT_CLUSTERS_X - 1);
+				range.x1 = Clamp((int)floorf((maxX*0.5f + 0.5f)*LIGHT_CLUSTERS_X), 0, LIGHT_CLUSTERS_X - 1);
+				range.y0 = Clamp((int)floorf((minY*0.5f + 0.5f)*LIGHT_CLUSTERS_Y), 0, LIGHT_CLUSTERS_Y - 1);
+				range.y1 = Clamp((int)floorf((maxY*0.5f + 0.5f)*LIGHT_CLUSTERS_Y), 0, LIGHT_CLUSTERS_Y - 1);
+			}
+			range.z0 = (nearZ > LIGHT_CLUSTER_NEAR) ? Clamp((int)(logf(nearZ/LIGHT_CLUSTER_NEAR)*depthScale), 0, LIGHT_CLUSTERS_Z - 1) : 0;
+			range.z1 = (farZ > LIGHT_CLUSTER_NEAR) ? Clamp((int)(logf(farZ/LIGHT_CLUSTER_NEAR)*depthScale), 0, LIGHT_CLUSTERS_Z - 1) : 0;
+			ranges.push_back(range);
+
+			for (int z = range.z0; z <= range.z1; z++)
+				for (int y = range.y0; y <= range.y1; y++)
+					for (int x = range.x0; x <= range.x1; x++) counts[z*tiles + y*LIGHT_CLUSTERS_X + x]++;
+		}
+
+		// Grid texels are (first index, count); lists that do not fit are cut short
+		grid.assign(tiles*LIGHT_CLUSTERS_Z*4, 0.0f);
+		int total = 0;
+		stats.maxClusterLights = 0;
+		stats.droppedIndices = 0;
+		for (size_t i = 0; i < counts.size(); i++)
+		{
+			int count = std::min(counts[i], LIGHT_INDEX_WIDTH*LIGHT_INDEX_ROWS - total);
+			stats.droppedIndices += counts[i] - count;
+			stats.maxClusterLights = std::max(stats.maxClusterLights, counts[i]);
+			grid[i*4 + 0] = (float)total;
+			grid[i*4 + 1] = (float)count;
+			counts[i] = 0;
+			total += count;
+		}
+
+		indices.resize(std::max(total, 1));
+		for (size_t l = 0; l < ranges.size(); l++)
+		{
+			const ClusterRange &range = ranges[l];
+			for (int z = range.z0; z <= range.z1; z++)
+				for (int y = range.y0; y <= range.y1; y++)
+					for (int x = range.x0; x <= range.x1; x++)
+					{
+						int cluster = z*tiles + y*LIGHT_CLUSTERS_X + x;
+						if (counts[cluster] < (int)grid[cluster*4 + 1]) indices[(int)grid[cluster*4 + 0] + counts[cluster]++] = (float)(firstPoint + l);
+					}
+		}
+
+		rlUpdateTexture(gridTexture.id, 0, 0, gridTexture.width, gridTexture.height, gridTexture.format, grid.data());
+		if (total > 0)
+		{
+			// Whole rows, padded after the last entry
+			int rows = (total + LIGHT_INDEX_WIDTH - 1)/LIGHT_INDEX_WIDTH;
+			indices.resize(rows*LIGHT_INDEX_WIDTH, 0.0f);
+			rlUpdateTexture(indexTexture.id, 0, 0, LIGHT_INDEX_WIDTH, rows, indexTexture.format, indices.data());
+		}
+		stats.clusterIndices = total;
+		stats.clusterUploads++;
+	}
+
+	Shader shader = { 0 };
+	Texture2D dataTexture = { 0 };
+	Texture2D gridTexture = { 0 };
+	Texture2D indexTexture = { 0 };
+	int lightCountLoc = -1;
+	int directionalCountLoc = -1;
+	int clusteredLoc = -1;
+	int clusterCountLoc = -1;
+	int clusterTileSizeLoc = -1;
+	int viewDepthLoc = -1;
+	int clusterDepthLoc = -1;
+
+	std::vector<SceneLight> lights;
+	bool dataDirty = true;
+	bool clustered = true;
+	Camera lastCamera = { 0 };
+	int lastWidth = 0;
+	int lastHeight = 0;
+
+	// Scratch kept between frames
+	std::vector<float> packed;
+	std::vector<SceneLight> points;
+	int firstPoint = 0;
+	std::vector<ClusterRange> ranges;
+	std::vector<int> counts;
+	std::vector<float> grid;
+	std::vector<float> indices;
+	LightStats stats = { 0 };
+};
+
+//----------------------------------------------------------------------------------
+// Shader cache
+// Linked programs are saved with glGetProgramBinary() in SHADER_CACHE_DIR, named
+// by a hash of both sources and the GL vendor, renderer and version strings, so
+// an edited shader or a driver update never picks up a stale binary. Later runs
+// link from the binary instead of compiling; if the driver rejects it the
+// sources are compiled again and the binary replaced. Without OpenGL 4.1 or
+// ARB_get_program_binary shaders are always compiled.
+//----------------------------------------------------------------------------------
+#define SHADER_CACHE_DIR        "shader_cache"
+#define SHADER_CACHE_VERSION    1
+
+typedef struct ShaderBinaryHeader {
+	char magic[4];                  // "ASHB"
+	unsigned int version;           // SHADER_CACHE_VERSION
+	unsigned long long key;         // Same as in the file name
+	unsigned int format;            // As returned by glGetProgramBinary()
+	unsigned int length;            // Bytes following the header
+} ShaderBinaryHeader;
+
+static_assert(sizeof(ShaderBinaryHeader) == 24, "ShaderBinaryHeader layout is part of the file format");
+
+// Read by a worker thread: the sources and, if there is one, the cached binary
+struct ShaderSources
+{
+	char *vsCode = nullptr;
+	char *fsCode = nullptr;
+	unsigned long long key = 0;
+	unsigned char *binary = nullptr;    // Header and program binary
+	int binarySize = 0;
+
+	void Free()
+	{
+		if (vsCode) UnloadFileText(vsCode);
+		if (fsCode) UnloadFileText(fsCode);
+		if (binary) UnloadFileData(binary);
+		*this = ShaderSources();
+	}
+};
+
+// Main thread: the driver part of the cache key
+static std::string ShaderCacheDriver()
+{
+	const char *strings[3] = { (const char *)glGetString(GL_VENDOR), (const char *)glGetString(GL_RENDERER), (const char *)glGetString(GL_VERSION) };
+	std::string driver;
+	for (const char *s : strings) driver += std::string(s ? s : "") + "|";
+	return driver;
+}
+
+static bool ShaderBinarySupported()
+{
+	if ((glad_glGetProgramBinary == nullptr) || (glad_glProgramBinary == nullptr)) return false;
+	int formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	return (formats > 0);
+}
+
+// Called from the loader and watcher threads, so no TextFormat() and its
+// shared static buffers
+static std::string ShaderCachePath(unsigned long long key)
+{
+	char path[64 + sizeof(SHADER_CACHE_DIR)];
+	snprintf(path, sizeof(path), SHADER_CACHE_DIR "/%016llx.bin", key);
+	return path;
+}
+
+// Any thread: reads both sources (an empty name stands for raylib's default
+// shader) and the binary cached for them. False if a source is missing.
+static bool ReadShaderSources(const char *vsFileName, const char *fsFileName, const std::string &driver, ShaderSources *sources)
+{
+	if (vsFileName[0] != '\0') sources->vsCode = LoadFileText(vsFileName);
+	if (fsFileName[0] != '\0') sources->fsCode = LoadFileText(fsFileName);
+	if (((vsFileName[0] != '\0') && !sources->vsCode) || ((fsFileName[0] != '\0') && !sources->fsCode)) return false;
+
+	// 64-bit FNV-1a; the zero after each part keeps "ab" + "c" apart from "a" + "bc"
+	unsigned long long key = 0xCBF29CE484222325ull;
+	for (const char *s : { driver.c_str(), (const char *)sources->vsCode, (const char *)sources->fsCode })
+	{
+		for (; s && *s; s++) key = (key ^ (unsigned char)*s)*0x100000001B3ull;
+		key *= 0x100000001B3ull;
+	}
+	sources->key = key;
+
+	std::string path = ShaderCachePath(key);
+	if (FileExists(path.c_str())) sources->binary = LoadFileData(path.c_str(), &sources->binarySize);
+	return true;
+}
+
+// Same locations, under raylib's default names, as LoadShaderFromMemory() sets
+static Shader ShaderFromProgram(unsigned int id)
+{
+	Shader shader = { 0 };
+	shader.id = id;
+	shader.locs = (int *)MemAlloc(RL_MAX_SHADER_LOCATIONS*sizeof(int));
+	for (int i = 0; i < RL_MAX_SHADER_LOCATIONS; i++) shader.locs[i] = -1;
+
+	shader.locs[SHADER_LOC_VERTEX_POSITION] = rlGetLocationAttrib(id, "vertexPosition");
+	shader.locs[SHADER_LOC_VERTEX_TEXCOORD01] = rlGetLocationAttrib(id, "vertexTexCoord");
+	shader.locs[SHADER_LOC_VERTEX_TEXCOORD02] = rlGetLocationAttrib(id, "vertexTexCoord2");
+	shader.locs[SHADER_LOC_VERTEX_NORMAL] = rlGetLocationAttrib(id, "vertexNormal");
+	shader.locs[SHADER_LOC_VERTEX_TANGENT] = rlGetLocationAttrib(id, "vertexTangent");
+	shader.locs[SHADER_LOC_VERTEX_COLOR] = rlGetLocationAttrib(id, "vertexColor");
+
+	shader.locs[SHADER_LOC_MATRIX_MVP] = rlGetLocationUniform(id, "mvp");
+	shader.locs[SHADER_LOC_MATRIX_VIEW] = rlGetLocationUniform(id, "matView");
+	shader.locs[SHADER_LOC_MATRIX_PROJECTION] = rlGetLocationUniform(id, "matProjection");
+	shader.locs[SHADER_LOC_MATRIX_MODEL] = rlGetLocationUniform(id, "matModel");
+	shader.locs[SHADER_LOC_MATRIX_NORMAL] = rlGetLocationUniform(id, "matNormal");
+
+	shader.locs[SHADER_LOC_COLOR_DIFFUSE] = rlGetLocationUniform(id, "colDiffuse");
+	shader.locs[SHADER_LOC_MAP_DIFFUSE] = rlGetLocationUniform(id, "texture0");
+	shader.locs[SHADER_LOC_MAP_SPECULAR] = rlGetLocationUniform(id, "texture1");
+	shader.locs[SHADER_LOC_MAP_NORMAL] = rlGetLocationUniform(id, "texture2");
+	return shader;
+}
+
+// Main thread: links the cached binary; an empty shader if it is missing, for
+// other sources or rejected by the driver
+static Shader LoadShaderBinary(const ShaderSources &sources)
+{
+	ShaderBinaryHeader header = { 0 };
+	if (!sources.binary || !ShaderBinarySupported() || (sources.binarySize < (int)sizeof(header))) return Shader{ 0 };
+	memcpy(&header, sources.binary, sizeof(header));
+	if ((memcmp(header.magic, "ASHB", 4) != 0) || (header.version != SHADER_CACHE_VERSION) || (header.key != sources.key) ||
+		(header.length != (unsigned int)sources.binarySize - sizeof(header))) return Shader{ 0 };
+
+	unsigned int id = glCreateProgram();
+	glProgramBinary(id, header.format, sources.binary + sizeof(header), (int)header.length);
+	int linked = 0;
+	glGetProgramiv(id, GL_LINK_STATUS, &linked);
+	if (!linked)
+	{
+		glDeleteProgram(id);
+		return Shader{ 0 };
+	}
+	return ShaderFromProgram(id);
+}
+
+static void SaveShaderBinary(Shader shader, unsigned long long key)
+{
+	if (!ShaderBinarySupported()) return;
+	int length = 0;
+	glGetProgramiv(shader.id, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) return;
+
+	std::vector<unsigned char> bytes(sizeof(ShaderBinaryHeader) + length);
+	ShaderBinaryHeader header = { { 'A', 'S', 'H', 'B' }, SHADER_CACHE_VERSION, key, 0, (unsigned int)length };
+	glGetProgramBinary(shader.id, length, nullptr, &header.format, bytes.data() + sizeof(header));
+	memcpy(bytes.data(), &header, sizeof(header));
+
+	if (!DirectoryExists(SHADER_CACHE_DIR))
+	{
+#if defined(_WIN32)
+		CreateDirectoryA(SHADER_CACHE_DIR, nullptr);
+#else
+		mkdir(SHADER_CACHE_DIR, 0755);
+#endif
+	}
+	SaveFileData(ShaderCachePath(key).c_str(), bytes.data(), (int)bytes.size());
+}
+
+// Main thread: from the cached binary when it links, otherwise compiled and
+// cached. 'cached' tells which; an empty shader if the sources do not build.
+static Shader LoadShaderCached(const ShaderSources &sources, bool *cached)
+{
+	Shader shader = LoadShaderBinary(sources);
+	*cached = (shader.id != 0);
+	if (*cached) return shader;
+
+	shader = LoadShaderFromMemory(sources.vsCode, sources.fsCode);
+	if (shader.id == rlGetShaderIdDefault())
+	{
+		MemFree(shader.locs);
+		return Shader{ 0 };
+	}
+	SaveShaderBinary(shader, sources.key);
+	return shader;
+}
+
+//----------------------------------------------------------------------------------
+// Asynchronous asset loading
+// Worker threads read and decode files into CPU memory (OBJ meshes or their
+// mapped cooked files, images, shader sources); the main thread uploads finished ones to the GPU in Update(),
+// within a time budget per frame. Until an asset is ready callers draw a
+// placeholder.
+// With WatchShaders() a thread also polls the sources of loaded shaders and
+// reads the ones that change; Update() rebuilds them between frames and swaps
+// the program only if the new one links.
+//----------------------------------------------------------------------------------
+#define SHADER_WATCH_INTERVAL_MS    250
+
+typedef enum {
+	ASYNC_MODEL = 0,
+	ASYNC_TEXTURE,
+	ASYNC_SHADER
+} AsyncKind;
+
+typedef enum {
+	ASYNC_QUEUED = 0,       // Waiting for a worker
+	ASYNC_DECODED,          // In CPU memory, waiting for upload
+	ASYNC_READY,            // On the GPU
+	ASYNC_FAILED
+} AsyncState;
+
+class AsyncLoader
+{
+public:
+	~AsyncLoader() { Stop(); }
+
+	void Start(int threadCount)
+	{
+		shaderDriver = ShaderCacheDriver();
+		running = true;
+		for (int i = 0; i < threadCount; i++) workers.emplace_back([this] { WorkerLoop(); });
+	}
+
+	// Joins the workers and frees every asset, uploaded or not. Call before CloseWindow().
+	void Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running = false;
+		}
+		wake.notify_all();
+		for (std::thread &worker : workers) worker.join();
+		workers.clear();
+		StopWatching();
+
+		for (auto &request : requests) Free(*request);
+		requests.clear();
+	}
+
+	// Each returns an id for the queries below
+	int LoadModelAsync(const char *fileName) { return Queue(ASYNC_MODEL, fileName, ""); }
+	int LoadTextureAsync(const char *fileName) { return Queue(ASYNC_TEXTURE, fileName, ""); }
+	int LoadShaderAsync(const char *vsFileName, const char *fsFileName) { return Queue(ASYNC_SHADER, vsFileName, fsFileName); }
+
+	// Hot reload of every shader loaded by this loader; call after Start()
+	void WatchShaders()
+	{
+		if (watcher.joinable()) return;
+		watching = true;
+		watcher = std::thread([this] { WatchLoop(); });
+	}
+
+	// Rebuilds changed shaders, then uploads decoded assets until 'budgetMs' has
+	// been spent; at least one per call so a large asset cannot stall the queue.
+	// Returns the number uploaded.
+	int Update(double budgetMs)
+	{
+		while (true)
+		{
+			Request *request = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (reloads.empty()) break;
+				request = reloads.front();
+				reloads.pop_front();
+			}
+			Reload(*request);
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		int uploaded = 0;
+		while (true)
+		{
+			Request *request = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (decoded.empty()) break;
+				request = decoded.front();
+				decoded.pop_front();
+			}
+			Upload(*request);
+			uploaded++;
+
+			double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (elapsedMs >= budgetMs) break;
+		}
+		return uploaded;
+	}
+
+	AsyncState State(int id) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return requests[id]->state;
+	}
+
+	bool IsReady(int id) const { return State(id) == ASYNC_READY; }
+
+	// Fraction of the requested assets that are ready or have failed, 0.0f..1.0f
+	float Progress() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (requests.empty()) return 1.0f;
+		int done = 0;
+		for (const auto &request : requests) done += (request->state == ASYNC_READY || request->state == ASYNC_FAILED);
+		return (float)done/(float)requests.size();
+	}
+
+	bool Finished() const { return Progress() >= 1.0f; }
+
+	// Valid once IsReady(id); owned by the loader
+	Model &GetModel(int id) { return requests[id]->model; }
+	const std::vector<BoundingBox> &GetMeshBounds(int id) const { return requests[id]->meshBounds; }
+	Texture2D GetTexture(int id) const { return requests[id]->texture; }
+	Shader GetShader(int id) const { return requests[id]->shader; }
+
+	// Counts the hot reloads of a shader; when it changes, GetShader() returns a new program
+	int GetShaderRevision(int id) const { return requests[id]->revision; }
+
+private:
+	struct Request
+	{
+		AsyncKind kind;
+		std::string fileName;
+		std::string fileName2;          // Fragment shader
+		AsyncState state = ASYNC_QUEUED;
+
+		// Decoded by a worker
+		CookedMesh cooked;              // Used when open, otherwise meshData
+		MeshData meshData;
+		bool meshDecoded = false;       // Otherwise loaded with LoadModel() on upload
+		Image image = { 0 };
+		ShaderSources sources;
+
+		// Hot reload, polled by the watcher
+		long vsModTime = 0;
+		long fsModTime = 0;
+		ShaderSources reload;
+		bool reloadPending = false;     // 'reload' belongs to the main thread
+		int revision = 0;
+
+		// Uploaded on the main thread
+		Model model = { 0 };
+		std::vector<BoundingBox> meshBounds;    // Model space, one per mesh
+		Texture2D texture = { 0 };
+		Shader shader = { 0 };
+	};
+
+	int Queue(AsyncKind kind, const char *fileName, const char *fileName2)
+	{
+		auto request = std::make_unique<Request>();
+		request->kind = kind;
+		request->fileName = fileName ? fileName : "";
+		request->fileName2 = fileName2 ? fileName2 : "";
+		int id;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			id = (int)requests.size();
+			queued.push_back(request.get());
+			requests.push_back(std::move(request));
+		}
+		wake.notify_one();
+		return id;
+	}
+
+	void WorkerLoop()
+	{
+		while (true)
+		{
+			Request *request = nullptr;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [this] { return !running || !queued.empty(); });
+				if (!running) return;
+				request = queued.front();
+				queued.pop_front();
+			}
+
+			bool ok = Decode(*request);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			request->state = ok ? ASYNC_DECODED : ASYNC_FAILED;
+			if (ok) decoded.push_back(request);
+		}
+	}
+
+	// CPU side only: no GL calls are allowed off the main thread
+	bool Decode(Request &request) const
+	{
+		const char *fileName = request.fileName.c_str();
+		switch (request.kind)
+		{
+			case ASYNC_MODEL:
+			{
+				// Other formats are parsed by LoadModel() on the main thread
+				if (!HasExtension(fileName, ".obj")) return FileExists(fileName);
+				if (OpenCookedMesh(CookedPath(fileName).c_str(), fileName, &request.cooked))
+				{
+					request.cooked.file.Prefault();
+					return true;
+				}
+				request.meshDecoded = ReadOBJ(fileName, &request.meshData);
+				if (!request.meshDecoded) TraceLog(LOG_WARNING, "ASYNC: [%s] Failed to parse OBJ", fileName);
+				return request.meshDecoded;
+			}
+			case ASYNC_TEXTURE:
+			{
+				if (!LoadCompressedImage(fileName, &request.image)) request.image = LoadImage(fileName);
+				return request.image.data != nullptr;
+			}
+			case ASYNC_SHADER:
+			{
+				if (!request.fileName.empty()) request.vsModTime = GetFileModTime(fileName);
+				if (!request.fileName2.empty()) request.fsModTime = GetFileModTime(request.fileName2.c_str());
+				return ReadShaderSources(fileName, request.fileName2.c_str(), shaderDriver, &request.sources);
+			}
+		}
+		return false;
+	}
+
+	void Upload(Request &request)
+	{
+		bool ok = false;
+		switch (request.kind)
+		{
+			case ASYNC_MODEL:
+			{
+				// Bounds come with cooked and parsed meshes; other formats are measured here
+				if (request.cooked.header)
+				{
+					request.model = UploadCookedMesh(request.cooked, request.fileName.c_str());
+					for (int i = 0; i < request.model.meshCount; i++)
+					{
+						const CookedPart &part = request.cooked.parts[i];
+						request.meshBounds.push_back(BoundingBox{ { part.boundsMin[0], part.boundsMin[1], part.boundsMin[2] }, { part.boundsMax[0], part.boundsMax[1], part.boundsMax[2] } });
+					}
+				}
+				else if (request.meshDecoded)
+				{
+					request.model = UploadMeshData(request.meshData, request.fileName.c_str());
+					for (const MeshPart &part : request.meshData.parts) request.meshBounds.push_back(part.bounds);
+					request.meshData = MeshData();  // Copied into the model
+				}
+				else
+				{
+					request.model = LoadModel(request.fileName.c_str());
+					for (int i = 0; i < request.model.meshCount; i++) request.meshBounds.push_back(GetMeshBoundingBox(request.model.meshes[i]));
+				}
+				ok = (request.model.meshCount > 0);
+			} break;
+			case ASYNC_TEXTURE:
+			{
+				request.texture = LoadTextureFromImage(request.image);
+				bool compressed = (request.image.format >= PIXELFORMAT_COMPRESSED_DXT1_RGB);
+				UnloadImage(request.image);
+				request.image = Image{ 0 };
+
+				// Without GPU support for the compressed format, fall back to the source
+				if ((request.texture.id == 0) && compressed) request.texture = LoadTexture(request.fileName.c_str());
+				ok = (request.texture.id != 0);
+			} break;
+			case ASYNC_SHADER:
+			{
+				auto start = std::chrono::steady_clock::now();
+				bool cached = false;
+				request.shader = LoadShaderCached(request.sources, &cached);
+				request.sources.Free();
+				ok = (request.shader.id != 0);
+				if (ok) TraceLog(LOG_INFO, "SHADER: [%s] %s in %.2f ms", request.fileName2.c_str(), cached ? "Linked from cached binary" : "Compiled and cached",
+								 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+			} break;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		request.state = ok ? ASYNC_READY : ASYNC_FAILED;
+	}
+
+	// A shader that fails to build keeps its previous program
+	void Reload(Request &request)
+	{
+		auto start = std::chrono::steady_clock::now();
+		bool cached = false;
+		Shader shader = LoadShaderCached(request.reload, &cached);
+		if (shader.id != 0)
+		{
+			UnloadShader(request.shader);
+			request.shader = shader;
+			request.revision++;
+			TraceLog(LOG_INFO, "SHADER: [%s] Reloaded in %.2f ms", request.fileName2.c_str(), std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		else TraceLog(LOG_WARNING, "SHADER: [%s] Reload failed, the previous program stays", request.fileName2.c_str());
+		request.reload.Free();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		request.reloadPending = false;
+	}
+
+	void WatchLoop()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (watching)
+		{
+			watchWake.wait_for(lock, std::chrono::milliseconds(SHADER_WATCH_INTERVAL_MS), [this] { return !watching; });
+			if (!watching) break;
+
+			std::vector<Request *> shaders;
+			for (auto &request : requests)
+			{
+				if ((request->kind == ASYNC_SHADER) && (request->state == ASYNC_READY) && !request->reloadPending) shaders.push_back(request.get());
+			}
+			lock.unlock();
+
+			// Modification times are only written by Decode(), before the shader is ready, and here
+			for (Request *request : shaders)
+			{
+				long vsModTime = request->fileName.empty() ? 0 : GetFileModTime(request->fileName.c_str());
+				long fsModTime = request->fileName2.empty() ? 0 : GetFileModTime(request->fileName2.c_str());
+				if ((vsModTime == request->vsModTime) && (fsModTime == request->fsModTime)) continue;
+
+				// Tried again next time if a file is missing, e.g. while an editor replaces it
+				ShaderSources sources;
+				if (!ReadShaderSources(request->fileName.c_str(), request->fileName2.c_str(), shaderDriver, &sources))
+				{
+					sources.Free();
+					continue;
+				}
+				request->vsModTime = vsModTime;
+				request->fsModTime = fsModTime;
+
+				std::lock_guard<std::mutex> reloadLock(mutex);
+				request->reload = sources;
+				request->reloadPending = true;
+				reloads.push_back(request);
+			}
+			lock.lock();
+		}
+	}
+
+	void StopWatching()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			watching = false;
+		}
+		watchWake.notify_all();
+		if (watcher.joinable()) watcher.join();
+		reloads.clear();
+	}
+
+	static void Free(Request &request)
+	{
+		if (request.image.data) UnloadImage(request.image);
+		request.sources.Free();
+		request.reload.Free();
+		if ((request.model.meshCount > 0) && request.cooked.header) UnloadCookedModel(request.model);
+		else if (request.model.meshCount > 0) UnloadModel(request.model);
+		request.cooked.file.Close();
+		if (request.texture.id != 0) UnloadTexture(request.texture);
+		if (request.shader.id != 0 && request.shader.id != rlGetShaderIdDefault()) UnloadShader(request.shader);
+	}
+
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	std::vector<std::thread> workers;
+	std::vector<std::unique_ptr<Request>> requests;
+	std::deque<Request *> queued;
+	std::deque<Request *> decoded;
+	bool running = false;
+	std::string shaderDriver;           // Part of the shader cache keys
+
+	std::thread watcher;
+	std::condition_variable watchWake;
+	std::deque<Request *> reloads;
+	bool watching = false;
+};
+
+// One instance at the origin, or 'count' on a grid with random models and headings
+static std::vector<SceneInstance> PlaceInstances(int count)
+{
+	std::vector<SceneInstance> instances(count);
+	int side = (int)ceilf(sqrtf((float)count));
+	SetRandomSeed(1);
+	for (int i = 0; i < count; i++)
+	{
+		Vector3 position = { 0.0f, 0.0f, 0.0f };
+		if (count > 1) position = { ((i%side) - 0.5f*(side - 1))*SCENE_SPACING, 0.0f, ((i/side) - 0.5f*(side - 1))*SCENE_SPACING };
+		float heading = (count > 1) ? (float)GetRandomValue(0, 359)*DEG2RAD : 0.0f;
+
+		instances[i].model = (count > 1) ? GetRandomValue(0, SCENE_MODELS - 1) : 0;
+		instances[i].transform = MatrixMultiply(MatrixMultiply(MatrixScale(SCENE_MODEL_SCALE, SCENE_MODEL_SCALE, SCENE_MODEL_SCALE), MatrixRotateY(heading)), MatrixTranslate(position.x, position.y, position.z));
+	}
+	return instances;
+}
+
+// Point lights of random colors and sizes over the scene, after the first SCENE_LIGHTS
+static void ScatterLights(LightManager *lights, int count, BoundingBox area)
+{
+	lights->Truncate(SCENE_LIGHTS);
+	SetRandomSeed(2);
+	for (int i = SCENE_LIGHTS; i < count; i++)
+	{
+		Vector3 position = {
+			Lerp(area.min.x, area.max.x, GetRandomValue(0, 1000)/1000.0f),
+			Lerp(0.5f, 3.0f, GetRandomValue(0, 1000)/1000.0f),
+			Lerp(area.min.z, area.max.z, GetRandomValue(0, 1000)/1000.0f)
+		};
+		lights->Add(LIGHT_POINT, position, Vector3Zero(), ColorFromHSV((float)GetRandomValue(0, 359), 0.8f, 1.0f), (float)GetRandomValue(2, 6));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	// Offline step: "--cook a.obj b.obj ..." writes a.amesh, b.amesh, ... next to the sources
+	if ((argc > 1) && (strcmp(argv[1], "--cook") == 0))
+	{
+		int failed = 0;
+		for (int i = 2; i < argc; i++) failed += !CookMesh(argv[i], CookedPath(argv[i]).c_str());
+		return (failed == 0) ? 0 : 1;
+	}
+
+	// "--stress [n]" starts in the stress scene, with n instances; "--lights n" with n lights;
+	// "--light-bench" prints the frame time for a range of light counts, with and without clusters;
+	// "--hot-reload" rebuilds shaders when their files change
+	int stressCount = SCENE_STRESS_INSTANCES;
+	bool stressScene = false;
+	int lightCount = SCENE_LIGHTS;
+	bool lightBench = false;
+	bool hotReload = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--light-bench") == 0) lightBench = true;
+		else if (strcmp(argv[i], "--hot-reload") == 0) hotReload = true;
+		else if ((strcmp(argv[i], "--lights") == 0) && (i + 1 < argc)) lightCount = Clamp(atoi(argv[++i]), SCENE_LIGHTS, LIGHTS_MAX);
+		if (strcmp(argv[i], "--stress") != 0) continue;
+		stressScene = true;
+		if ((i + 1 < argc) && (atoi(argv[i + 1]) > 0)) stressCount = atoi(argv[++i]);
+	}
+
 	const int screenWidth = 1280;
 	const int screenHeight = 720;
+	const double uploadBudgetMs = 4.0;      // GPU upload time per frame for async assets
 
 	SetConfigFlags(FLAG_MSAA_4X_HINT);      // Enable Multi Sampling Anti Aliasing 4x (if available)
 
@@ -22,33 +1850,57 @@ int main(void)
 	camera.fovy = 45.0f;                                // Camera field-of-view Y
 	camera.projection = CAMERA_PERSPECTIVE;             // Camera projection type
 
-	Model model = LoadModel("../resources/models/watermill.obj"); // Load OBJ model
-	Texture2D texture = LoadTexture("../resources/models/watermill_diffuse.png"); // Load model texture
-
-	// Load shader for model
-	// NOTE: Defining 0 (NULL) for vertex shader forces usage of internal default vertex shader
-	Shader shader = LoadShader(TextFormat("../resources/shaders/glsl330/lighting.vs", GLSL_VERSION),
-														 TextFormat("../resources/shaders/glsl330/lighting.fs", GLSL_VERSION));
-
-	model.materials[0].shader = shader;                     // Set shader effect to 3d model
-	model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = texture; // Bind texture to model
-
-	Vector3 position = { 0.0f, 0.0f, 0.0f };    // Set model position
-	
-	// Ambient light level (some basic lighting)
-	int ambientLoc = GetShaderLocation(shader, "ambient");
-	float val_t[] { 0.1f, 0.1f, 0.1f, 1.0f };
-	SetShaderValue(shader, ambientLoc, val_t, SHADER_UNIFORM_VEC4);
-	
-	// Create lights
-	Light lights[MAX_LIGHTS] = { 0 };
-	lights[0] = CreateLight(LIGHT_POINT, { -4, 1, -4 }, Vector3Zero(), YELLOW, shader);
-	lights[1] = CreateLight(LIGHT_POINT, { 4, 1, 4 }, Vector3Zero(), RED, shader);
-	lights[2] = CreateLight(LIGHT_POINT, { -4, 1, 4 }, Vector3Zero(), GREEN, shader);
-	lights[3] = CreateLight(LIGHT_POINT, { 4, 1, -4 }, Vector3Zero(), BLUE, shader);
+	// Load models, textures and shader in the background; the first frame does not wait for them
+	AsyncLoader loader;
+	loader.Start(2);
+	if (hotReload) loader.WatchShaders();
+	const char *modelNames[SCENE_MODELS] = { "watermill", "church", "barracks" };
+	int modelIds[SCENE_MODELS] = { 0 };
+	int textureIds[SCENE_MODELS] = { 0 };
+	for (int i = 0; i < SCENE_MODELS; i++)
+	{
+		modelIds[i] = loader.LoadModelAsync(TextFormat("../resources/models/%s.obj", modelNames[i]));             // Load OBJ model
+		textureIds[i] = loader.LoadTextureAsync(TextFormat("../resources/models/%s_diffuse.png", modelNames[i])); // Load model texture
+	}
+	int shaderId = loader.LoadShaderAsync(TextFormat("../resources/shaders/glsl%i/lighting.vs", GLSL_VERSION),
+										  TextFormat("../resources/shaders/glsl%i/lighting_clustered.fs", GLSL_VERSION));
+
+	// Placeholders drawn until the real assets are ready: a cube of about the
+	// watermill's size at the model scale, with a checkerboard texture
+	Model placeholderModel = LoadModelFromMesh(GenMeshCube(20.0f, 20.0f, 20.0f));
+	Image checked = GenImageChecked(64, 64, 8, 8, LIGHTGRAY, GRAY);
+	Texture2D placeholderTexture = LoadTextureFromImage(checked);
+	UnloadImage(checked);
+	Shader defaultShader = placeholderModel.materials[0].shader;
+	const std::vector<BoundingBox> placeholderBounds = { GetMeshBoundingBox(placeholderModel.meshes[0]) };
+
+	Shader shader = defaultShader;
+	bool shaderReady = false;
+	int shaderRevision = -1;
+
+	// Scene instances and the tree over them, rebuilt when a model replaces its placeholder
+	std::vector<SceneInstance> instances = PlaceInstances(stressScene ? stressCount : 1);
+	SceneBVH bvh;
+	BoundingBox sceneBounds = { 0 };
+	int sceneReadyMask = -1;
+	bool culling = true;
+
+	// Lights are created once the lighting shader is ready
+	LightManager lights;
+	const int lightSteps[] = { SCENE_LIGHTS, 64, 256, LIGHTS_MAX };
+	bool movingLights = false;
+
+	// Light benchmark: every light count is drawn with and without clusters, from the start camera
+	const int benchCounts[] = { 4, 16, 64, 256, 1024 };
+	const int benchWarmup = 10;
+	const int benchFrames = 60;
+	int benchStep = 0;
+	int benchFrame = 0;
+	double benchTime = 0.0;
+	double benchResults[2][sizeof(benchCounts)/sizeof(benchCounts[0])] = { 0 };
 
 	DisableCursor();                    // Limit cursor to relative movement inside the window
-	SetTargetFPS(60);                   // Set our game to run at 60 frames-per-second
+	SetTargetFPS(lightBench ? 0 : 60);  // Set our game to run at 60 frames-per-second
 	//--------------------------------------------------------------------------------------
 
 	// Main game loop
@@ -56,16 +1908,133 @@ int main(void)
 	{
 		// Update
 		//----------------------------------------------------------------------------------
-		UpdateCamera(&camera, CAMERA_FREE);
-		float cameraPos[3] = { camera.position.x, camera.position.y, camera.position.z };
-		SetShaderValue(shader, shader.locs[SHADER_LOC_VECTOR_VIEW], cameraPos, SHADER_UNIFORM_VEC3);
-		
-		if (IsKeyPressed(KEY_Y)) { lights[0].enabled = !lights[0].enabled; }
-		if (IsKeyPressed(KEY_R)) { lights[1].enabled = !lights[1].enabled; }
-		if (IsKeyPressed(KEY_G)) { lights[2].enabled = !lights[2].enabled; }
-		if (IsKeyPressed(KEY_B)) { lights[3].enabled = !lights[3].enabled; }
-		
-		for (int i = 0; i < MAX_LIGHTS; i++) UpdateLightValues(shader, lights[i]);
+		loader.Update(uploadBudgetMs);
+
+		// The lighting shader arrives, or comes back from a hot reload with its uniforms reset
+		if (loader.IsReady(shaderId) && (loader.GetShaderRevision(shaderId) != shaderRevision))
+		{
+			shader = loader.GetShader(shaderId);
+			shaderRevision = loader.GetShaderRevision(shaderId);
+
+			// Ambient light level (some basic lighting)
+			int ambientLoc = GetShaderLocation(shader, "ambient");
+			float val_t[] { 0.1f, 0.1f, 0.1f, 1.0f };
+			SetShaderValue(shader, ambientLoc, val_t, SHADER_UNIFORM_VEC4);
+
+			if (shaderReady) lights.SetShader(shader);
+			else
+			{
+				// Create lights
+				lights.Init(shader);
+				lights.Add(LIGHT_POINT, { -4, 1, -4 }, Vector3Zero(), YELLOW, 40.0f);
+				lights.Add(LIGHT_POINT, { 4, 1, 4 }, Vector3Zero(), RED, 40.0f);
+				lights.Add(LIGHT_POINT, { -4, 1, 4 }, Vector3Zero(), GREEN, 40.0f);
+				lights.Add(LIGHT_POINT, { 4, 1, -4 }, Vector3Zero(), BLUE, 40.0f);
+				sceneReadyMask = -1;    // Scatters the other lights
+			}
+			shaderReady = true;
+		}
+
+		if (!lightBench) UpdateCamera(&camera, CAMERA_FREE);
+		if (shaderReady)
+		{
+			float cameraPos[3] = { camera.position.x, camera.position.y, camera.position.z };
+			SetShaderValue(shader, shader.locs[SHADER_LOC_VECTOR_VIEW], cameraPos, SHADER_UNIFORM_VEC3);
+
+			if (IsKeyPressed(KEY_Y)) { lights.Edit(0).enabled = !lights.Get(0).enabled; }
+			if (IsKeyPressed(KEY_R)) { lights.Edit(1).enabled = !lights.Get(1).enabled; }
+			if (IsKeyPressed(KEY_G)) { lights.Edit(2).enabled = !lights.Get(2).enabled; }
+			if (IsKeyPressed(KEY_B)) { lights.Edit(3).enabled = !lights.Get(3).enabled; }
+
+			if (IsKeyPressed(KEY_K)) lights.SetClustered(!lights.IsClustered());
+			if (IsKeyPressed(KEY_M)) movingLights = !movingLights;
+			if (IsKeyPressed(KEY_L))
+			{
+				int step = 0;
+				while ((step < 3) && (lightSteps[step] <= lightCount)) step++;
+				lightCount = (lightSteps[step] <= lightCount) ? lightSteps[0] : lightSteps[step];
+				ScatterLights(&lights, lightCount, sceneBounds);
+			}
+
+			// Scattered lights circle the scene center
+			if (movingLights)
+			{
+				float angle = 0.2f*GetFrameTime();
+				Vector3 center = Vector3Scale(Vector3Add(sceneBounds.min, sceneBounds.max), 0.5f);
+				for (int i = SCENE_LIGHTS; i < lights.Count(); i++)
+				{
+					SceneLight &light = lights.Edit(i);
+					light.position = Vector3Add(center, Vector3RotateByAxisAngle(Vector3Subtract(light.position, center), { 0.0f, 1.0f, 0.0f }, angle));
+				}
+			}
+		}
+
+		if (IsKeyPressed(KEY_C)) culling = !culling;
+		if (IsKeyPressed(KEY_V))
+		{
+			stressScene = !stressScene;
+			instances = PlaceInstances(stressScene ? stressCount : 1);
+			sceneReadyMask = -1;
+		}
+
+		// The benchmark starts once everything is loaded; then each light count is measured in both modes
+		if (lightBench && shaderReady && loader.Finished())
+		{
+			int count = sizeof(benchCounts)/sizeof(benchCounts[0]);
+			if ((benchFrame == 0) && (benchStep < 2*count))
+			{
+				ScatterLights(&lights, benchCounts[benchStep/2], sceneBounds);
+				lights.SetClustered(benchStep%2 == 0);
+			}
+			else if (benchFrame > benchWarmup) benchTime += GetFrameTime();
+
+			if (++benchFrame > benchWarmup + benchFrames)
+			{
+				benchResults[benchStep%2][benchStep/2] = 1000.0*benchTime/benchFrames;
+				benchTime = 0.0;
+				benchFrame = 0;
+				if (++benchStep == 2*count)
+				{
+					printf("%i instances, %ix%i\n", (int)instances.size(), GetRenderWidth(), GetRenderHeight());
+					printf("lights   clustered ms   all lights ms\n");
+					for (int i = 0; i < count; i++) printf("%6i   %12.2f   %13.2f\n", benchCounts[i], benchResults[0][i], benchResults[1][i]);
+					break;
+				}
+			}
+		}
+
+		// Whatever has arrived so far replaces its placeholder
+		Model *models[SCENE_MODELS] = { 0 };
+		const std::vector<BoundingBox> *meshBounds[SCENE_MODELS] = { 0 };
+		int readyMask = 0;
+		for (int i = 0; i < SCENE_MODELS; i++)
+		{
+			bool ready = loader.IsReady(modelIds[i]);
+			readyMask |= ready ? (1 << i) : 0;
+			models[i] = ready ? &loader.GetModel(modelIds[i]) : &placeholderModel;
+			meshBounds[i] = ready ? &loader.GetMeshBounds(modelIds[i]) : &placeholderBounds;
+			if (shaderReady) lights.Bind(&models[i]->materials[0]);   // Set shader effect to 3d model
+			models[i]->materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = (ready && loader.IsReady(textureIds[i])) ? loader.GetTexture(textureIds[i]) : placeholderTexture; // Bind texture to model
+		}
+
+		if (readyMask != sceneReadyMask)
+		{
+			std::vector<BoundingBox> bounds(instances.size());
+			for (size_t i = 0; i < instances.size(); i++)
+			{
+				SceneInstance &instance = instances[i];
+				Matrix world = MatrixMultiply(models[instance.model]->transform, instance.transform);
+				const std::vector<BoundingBox> &local = *meshBounds[instance.model];
+				instance.bounds = TransformBoundingBox(local[0], world);
+				for (size_t m = 1; m < local.size(); m++) instance.bounds = MergeBoundingBox(instance.bounds, TransformBoundingBox(local[m], world));
+				bounds[i] = instance.bounds;
+				sceneBounds = (i == 0) ? instance.bounds : MergeBoundingBox(sceneBounds, instance.bounds);
+			}
+			bvh.Build(bounds);
+			sceneReadyMask = readyMask;
+			if (shaderReady && !lightBench) ScatterLights(&lights, lightCount, sceneBounds);
+		}
+		if (shaderReady) lights.Update(camera, GetRenderWidth(), GetRenderHeight());
 		//----------------------------------------------------------------------------------
 
 		// Draw
@@ -76,22 +2045,51 @@ int main(void)
 
 		BeginMode3D(camera);
 
-		DrawModel(model, position, 0.2f, WHITE);   // Draw 3d model with texture
-		
-		// Draw spheres to show where the lights are
-		for (int i = 0; i < MAX_LIGHTS; i++)
+		// Draw only the meshes inside the camera frustum
+		CullStats cullStats = { 0 };
+		for (const SceneInstance &instance : instances) cullStats.meshesTotal += models[instance.model]->meshCount;
+		Frustum frustum = GetCameraFrustum(camera, (float)GetScreenWidth()/(float)GetScreenHeight());
+		if (culling)
 		{
-			if (lights[i].enabled) DrawSphereEx(lights[i].position, 0.2f, 8, 8, lights[i].color);
-			else DrawSphereWires(lights[i].position, 0.2f, 8, 8, ColorAlpha(lights[i].color, 0.3f));
+			bvh.Query(frustum, &cullStats, [&](int i, bool inside) {
+				const SceneInstance &instance = instances[i];
+				DrawModelCulled(*models[instance.model], *meshBounds[instance.model], instance.transform, inside ? nullptr : &frustum, &cullStats);
+			});
+		}
+		else
+		{
+			for (const SceneInstance &instance : instances) DrawModelCulled(*models[instance.model], *meshBounds[instance.model], instance.transform, nullptr, &cullStats);
+		}
+
+		// Draw spheres to show where the lights are, and small cubes for the scattered ones
+		for (int i = 0; i < (shaderReady ? lights.Count() : 0); i++)
+		{
+			const SceneLight &light = lights.Get(i);
+			if (i >= SCENE_LIGHTS) DrawCube(light.position, 0.1f, 0.1f, 0.1f, light.color);
+			else if (light.enabled) DrawSphereEx(light.position, 0.2f, 8, 8, light.color);
+			else DrawSphereWires(light.position, 0.2f, 8, 8, ColorAlpha(light.color, 0.3f));
 		}
 
 		DrawGrid(10, 1.0f);     // Draw a grid
 
 		EndMode3D();
 
+		if (!loader.Finished())
+		{
+			float progress = loader.Progress();
+			DrawRectangle(10, screenHeight - 30, 200, 12, LIGHTGRAY);
+			DrawRectangle(10, screenHeight - 30, (int)(200*progress), 12, DARKGREEN);
+			DrawText(TextFormat("Loading %i%%", (int)(progress*100)), 220, screenHeight - 31, 10, DARKGRAY);
+		}
+
 		DrawText("(c) Watermill 3D model by Alberto Cano", screenWidth - 210, screenHeight - 20, 10, GRAY);
 
 		DrawFPS(10, 10);
+		DrawText(TextFormat("%i instances, %i meshes - [V] stress scene, [C] culling %s", (int)instances.size(), cullStats.meshesTotal, culling ? "on" : "off"), 10, 40, 10, DARKGRAY);
+		DrawText(TextFormat("tested: %i nodes, %i meshes - visible: %i - submitted: %i", cullStats.nodesTested, cullStats.meshesTested, cullStats.meshesVisible, cullStats.meshesSubmitted), 10, 55, 10, DARKGRAY);
+		const LightStats &lightStats = lights.GetStats();
+		DrawText(TextFormat("%i lights - [L] more lights, [K] clusters %s, [M] move lights", lights.Count(), lights.IsClustered() ? "on" : "off"), 10, 70, 10, DARKGRAY);
+		DrawText(TextFormat("cluster entries: %i (longest %i) - uploads: %i light data, %i clusters", lightStats.clusterIndices, lightStats.maxClusterLights, lightStats.dataUploads, lightStats.clusterUploads), 10, 85, 10, DARKGRAY);
 
 		EndDrawing();
 		//----------------------------------------------------------------------------------
@@ -99,9 +2097,10 @@ int main(void)
 
 	// De-Initialization
 	//--------------------------------------------------------------------------------------
-	UnloadShader(shader);       // Unload shader
-	UnloadTexture(texture);     // Unload texture
-	UnloadModel(model);         // Unload model
+	lights.Unload();
+	loader.Stop();                      // Unload model, texture and shader
+	UnloadTexture(placeholderTexture);  // Unload placeholders
+	UnloadModel(placeholderModel);
 
 	CloseWindow();              // Close window and OpenGL context
 	//--------------------------------------------------------------------------------------